@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+#
+# frame_assets.py
+# Build-time generator of frame assets stores for Pervasive_Touch_Small
+# ----------------------------------
+#
+# Project Pervasive Displays Library Suite
+# Based on highView technology
+#
+# Copyright (c) Pervasive Displays Inc., 2021-2026
+# Licence All rights reserved
+#
+# Input   binary PBM (P4) images, 1 = black, in native orientation
+#         2.71": 176 x 264, 3.70": 240 x 416
+# Output  binary store for a file or flash partition, or C header with a const array
+#
+# Example
+#   frame_assets.py --size 271 --output menus.h 1=menu.pbm 2=splash.pbm 3=error.pbm
+#
+
+import argparse
+import struct
+import sys
+
+ASSET_VERSION = 1
+SIZES = {271: (176, 264), 370: (240, 416)}
+
+
+def read_pbm(path):
+    with open(path, "rb") as file:
+        data = file.read()
+
+    # Header: magic, width, height, with optional comments
+    fields = []
+    position = 0
+    while len(fields) < 3:
+        while data[position:position + 1].isspace():
+            position += 1
+        if data[position:position + 1] == b"#":
+            while data[position:position + 1] not in (b"\n", b""):
+                position += 1
+            continue
+        start = position
+        while not data[position:position + 1].isspace():
+            position += 1
+        fields.append(data[start:position])
+    position += 1  # Single whitespace before raster
+
+    if fields[0] != b"P4":
+        sys.exit("%s: binary PBM (P4) expected" % path)
+    return int(fields[1]), int(fields[2]), data[position:]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate a frame assets store")
+    parser.add_argument("--size", type=int, required=True, choices=sorted(SIZES), help="screen size")
+    parser.add_argument("--output", required=True, help="store, .h for a C header")
+    parser.add_argument("--name", default="frameAssets", help="array name for a C header")
+    parser.add_argument("frames", nargs="+", help="identifier=image.pbm")
+    arguments = parser.parse_args()
+
+    width, height = SIZES[arguments.size]
+    sizeFrame = width * height // 8
+
+    entries = []
+    frames = b""
+    offset = 8 + 12 * len(arguments.frames)
+    for item in arguments.frames:
+        identifier, path = item.split("=", 1)
+        x, y, raster = read_pbm(path)
+        if (x, y) != (width, height):
+            sys.exit("%s: %i x %i, expected %i x %i" % (path, x, y, width, height))
+        if len(raster) < sizeFrame:
+            sys.exit("%s: raster of %i bytes, expected %i" % (path, len(raster), sizeFrame))
+        raster = raster[:sizeFrame]
+        entries.append(struct.pack("<HHII", arguments.size, int(identifier, 0), offset + len(frames), sizeFrame))
+        frames += raster
+
+    store = b"PDFA" + struct.pack("<BBH", ASSET_VERSION, 0, len(entries)) + b"".join(entries) + frames
+
+    if arguments.output.endswith(".h"):
+        with open(arguments.output, "w") as file:
+            file.write("// Generated by frame_assets.py, screen size %i\n" % arguments.size)
+            file.write("const uint8_t %s[%i] = {\n" % (arguments.name, len(store)))
+            for start in range(0, len(store), 16):
+                file.write("    " + ", ".join("0x%02x" % value for value in store[start:start + 16]) + ",\n")
+            file.write("};\n")
+    else:
+        with open(arguments.output, "wb") as file:
+            file.write(store)
+
+
+if __name__ == "__main__":
+    main()
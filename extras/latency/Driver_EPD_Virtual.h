@@ -0,0 +1,56 @@
+//
+// Driver_EPD_Virtual.h
+// Host stand-in for the latency harness
+// ----------------------------------
+//
+// Project Pervasive Displays Library Suite
+// Based on highView technology
+//
+// Copyright (c) Pervasive Displays Inc., 2021-2026
+// Licence All rights reserved
+//
+// Minimal subset of Driver_EPD_Virtual used by Pervasive_Touch_Small
+// Board functions are implemented in hV_HAL_Simulated.cpp
+//
+
+#ifndef DRIVER_EPD_VIRTUAL_RELEASE
+#define DRIVER_EPD_VIRTUAL_RELEASE 902
+
+#include "PDLS_Common.h"
+
+class Driver_EPD_Virtual
+{
+  public:
+
+    virtual ~Driver_EPD_Virtual() = default;
+
+  protected:
+
+    // Screen
+    uint8_t d_COG = 0;
+    eScreen_EPD_t u_eScreen_EPD = 0;
+    bool u_flagOTP = false;
+    int8_t u_temperature = 25;
+
+    // Board
+    pins_t b_pin = {0};
+    uint32_t b_delayCS = 50; // us
+    uint8_t b_fsmPowerScreen = FSM_OFF;
+
+    void b_begin(pins_t board, uint8_t family, uint16_t delayCS);
+    void b_reset(uint32_t ms1, uint32_t ms2, uint32_t ms3, uint32_t ms4, uint32_t ms5);
+    void b_waitBusy(bool state = HIGH);
+    void b_suspend(uint8_t suspendScope = POWER_SCOPE_GPIO_ONLY);
+    void b_resume();
+
+    void b_sendCommand8(uint8_t command);
+    void b_sendCommandData8(uint8_t command, uint8_t data);
+    void b_sendIndexData(uint8_t index, const uint8_t * data, uint32_t size);
+    void b_sendIndexFixed(uint8_t index, uint8_t data, uint32_t size);
+
+    // Touch
+    virtual void d_getRawTouch(touch_t & touch) = 0;
+    virtual bool d_getInterruptTouch() = 0;
+};
+
+#endif // DRIVER_EPD_VIRTUAL_RELEASE
@@ -0,0 +1,134 @@
+//
+// PDLS_Common.h
+// Host stand-in for the latency harness
+// ----------------------------------
+//
+// Project Pervasive Displays Library Suite
+// Based on highView technology
+//
+// Copyright (c) Pervasive Displays Inc., 2021-2026
+// Licence All rights reserved
+//
+// Minimal subset of PDLS_Common used by Pervasive_Touch_Small,
+// so the driver builds and runs on a Linux host against hV_HAL_Simulated.cpp
+// Not for Arduino, the library uses the actual PDLS_Common
+//
+
+#ifndef PDLS_COMMON_RELEASE
+#define PDLS_COMMON_RELEASE 902
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Types
+#define FRAMEBUFFER_CONST_TYPE const uint8_t *
+#define STRING_CONST_TYPE const char *
+typedef uint32_t eScreen_EPD_t;
+
+struct pins_t
+{
+    uint8_t panelBusy;
+    uint8_t panelDC;
+    uint8_t panelReset;
+    uint8_t panelCS;
+    uint8_t touchInt;
+    uint8_t touchReset;
+};
+
+struct touch_t
+{
+    uint16_t x;
+    uint16_t y;
+    uint16_t z;
+    uint8_t t;
+};
+
+// Screens
+#define SCREEN(size, film, driver) ((size) << 8 | (film) << 4 | (driver))
+#define EXTRA(extra) ((extra) << 20)
+#define SCREEN_SIZE(screen) (((screen) >> 8) & 0x03ff)
+#define SCREEN_FILM(screen) ((((screen) >> 4) & 0x0f) == FILM_P ? 'P' : 'K')
+#define SCREEN_DRIVER(screen) ("0123456789ABCDEF"[(screen) & 0x0f])
+
+#define SIZE_271 271
+#define SIZE_343 343
+#define SIZE_370 370
+#define FILM_P 1
+#define FILM_K 2
+#define DRIVER_9 0x09
+#define DRIVER_B 0x0b
+#define DRIVER_C 0x0c
+#define EXTRA_TOUCH 1
+
+#define COG_TOUCH_SMALL 0x31
+#define COG_WIDE_SMALL 0x21
+#define FAMILY_SMALL 0x01
+
+// Constants
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define NOT_CONNECTED 0xff
+
+#define FSM_OFF 0x00
+#define FSM_BUS_MASK 0x01
+#define FSM_GPIO_MASK 0x02
+#define FSM_SLEEP 0x01
+#define FSM_ON 0x03
+#define POWER_SCOPE_GPIO_ONLY 0x01
+
+#define LEVEL_CRITICAL 1
+#define LEVEL_ERROR 2
+#define LEVEL_WARNING 3
+#define LEVEL_INFO 4
+#define LEVEL_DEBUG 5
+
+#define RESULT_SUCCESS 0
+#define RESULT_ERROR 1
+
+#define UPDATE_NORMAL 1
+#define UPDATE_FAST 2
+
+#define TOUCH_EVENT_NONE 0
+#define TOUCH_EVENT_PRESS 1
+#define TOUCH_EVENT_RELEASE 2
+#define TOUCH_EVENT_MOVE 3
+
+#define DEBUG_OTP 0
+#define DEBUG_POWER 0
+
+// Hardware abstraction layer, simulated
+void hV_HAL_Serial_crlf();
+void hV_HAL_log(uint8_t level, const char * format, ...);
+void hV_HAL_exit(uint8_t code = 0x00);
+
+void hV_HAL_GPIO_define(uint8_t pin, uint8_t mode);
+void hV_HAL_GPIO_set(uint8_t pin);
+void hV_HAL_GPIO_clear(uint8_t pin);
+uint8_t hV_HAL_GPIO_get(uint8_t pin);
+
+void hV_HAL_SPI_begin(uint32_t speed = 8000000);
+void hV_HAL_SPI_end();
+uint8_t hV_HAL_SPI_transfer(uint8_t data);
+
+void hV_HAL_SPI3_begin();
+void hV_HAL_SPI3_end();
+void hV_HAL_SPI3_write(uint8_t data);
+uint8_t hV_HAL_SPI3_read();
+
+void hV_HAL_Wire_begin();
+void hV_HAL_Wire_end();
+uint8_t hV_HAL_Wire_transfer(uint8_t address, uint8_t * dataWrite, size_t sizeWrite, uint8_t * dataRead = 0, size_t sizeRead = 0);
+
+void hV_HAL_delayMilliseconds(uint32_t ms);
+void hV_HAL_delayMicroseconds(uint32_t us);
+uint32_t hV_HAL_getMilliseconds();
+uint32_t hV_HAL_getMicroseconds();
+
+// Utilities
+STRING_CONST_TYPE formatString(const char * format, ...);
+void debugOTP(uint8_t * COG_data, uint16_t size, uint8_t COG, uint8_t driver);
+
+#endif // PDLS_COMMON_RELEASE
@@ -0,0 +1,539 @@
+//
+// hV_HAL_Simulated.cpp
+// Simulated board and touch controller for the latency harness
+// ----------------------------------
+//
+// Project Pervasive Displays Library Suite
+// Based on highView technology
+//
+// Copyright (c) Pervasive Displays Inc., 2021-2026
+// Licence All rights reserved
+//
+// See hV_HAL_Simulated.h for references
+//
+// Timings are nominal, adjust them to the measures of the actual panel
+//
+
+#include "hV_HAL_Simulated.h"
+#include "Driver_EPD_Virtual.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+//
+// === Panel timings, ms
+//
+#define PANEL_SOFT_RESET 5 // 0x00 0x0e
+#define PANEL_POWER_ON 40 // 0x04
+#define PANEL_REFRESH_NORMAL 1600 // 0x12, normal update
+#define PANEL_REFRESH_FAST 300 // 0x12, fast update, temperature | 0x40
+#define PANEL_POWER_OFF 20 // 0x02
+//
+// I2C at 400 kHz, 9 bits per byte
+#define WIRE_BYTE_NS 22500
+// Bit-banged 3-wire SPI
+#define SPI3_BYTE_NS 10000
+//
+// === End of Panel timings
+//
+
+static uint64_t clockNow = 0; // ns
+static uint8_t logLevel = LEVEL_WARNING;
+
+static pins_t pins = {0};
+static uint8_t levels[256] = {0};
+
+// Panel
+static uint32_t speedSPI = 8000000;
+static uint32_t speedLimit = 16000000; // Commands lost above
+static uint8_t panelCommand = 0x00;
+static uint32_t panelData = 0;
+static bool flagFast = false;
+static uint64_t busyUntil = 0; // ns
+
+// OTP
+static uint16_t otpIndex = 0;
+static uint16_t otpPSR = 0;
+
+// Touch
+static uint8_t touchAddress = 0x00;
+static const contact_t * contacts = nullptr;
+static uint32_t contactNumber = 0;
+static uint32_t contactCurrent = 0; // First contact not yet released
+static uint32_t contactEdge = 0; // Next contact for interrupt edge
+static bool flagTouchSleep = false;
+static void (*touchISR)() = nullptr;
+
+static void advance(uint64_t duration)
+{
+    uint64_t target = clockNow + duration;
+
+    // Falling edges of INT, ISR at edge time
+    while ((contactEdge < contactNumber) and ((uint64_t)contacts[contactEdge].down * 1000000 <= target))
+    {
+        uint64_t edge = (uint64_t)contacts[contactEdge].down * 1000000;
+        clockNow = (edge > clockNow) ? edge : clockNow;
+        contactEdge += 1;
+
+        if ((touchISR != nullptr) and (flagTouchSleep == false))
+        {
+            touchISR();
+        }
+    }
+    clockNow = target;
+}
+
+static const contact_t * getContact()
+{
+    uint32_t chrono = clockNow / 1000000;
+
+    while ((contactCurrent < contactNumber) and (contacts[contactCurrent].up <= chrono))
+    {
+        contactCurrent += 1;
+    }
+
+    if ((flagTouchSleep == false) and (contactCurrent < contactNumber) and (contacts[contactCurrent].down <= chrono))
+    {
+        return &contacts[contactCurrent];
+    }
+    return nullptr;
+}
+
+//
+// === Harness
+//
+void simulated_begin(pins_t board, uint8_t address, const contact_t * script, uint32_t number)
+{
+    pins = board;
+    touchAddress = address;
+    contacts = script;
+    contactNumber = number;
+    contactCurrent = 0;
+    contactEdge = 0;
+    otpIndex = 0;
+    otpPSR = (address == 0x41) ? 0x004b : 0x0fb4; // 2.71" or 3.70" bank 0
+}
+
+void simulated_attachInterrupt(void (*isr)())
+{
+    touchISR = isr;
+}
+
+void simulated_setSpeedLimit(uint32_t speed)
+{
+    speedLimit = speed;
+}
+
+void simulated_setLogLevel(uint8_t level)
+{
+    logLevel = level;
+}
+//
+// === End of Harness
+//
+
+//
+// === Serial and log
+//
+void hV_HAL_Serial_crlf()
+{
+    ;
+}
+
+void hV_HAL_log(uint8_t level, const char * format, ...)
+{
+    if (level > logLevel)
+    {
+        return;
+    }
+
+    static const char * stringLevel[] = {"", "CRITICAL", "ERROR", "WARNING", "INFO", "DEBUG"};
+    va_list args;
+
+    fprintf(stderr, "%8u %-8s ", (uint32_t)(clockNow / 1000000), stringLevel[level]);
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+}
+
+void hV_HAL_exit(uint8_t code)
+{
+    exit(code);
+}
+
+STRING_CONST_TYPE formatString(const char * format, ...)
+{
+    static char buffer[128];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    return buffer;
+}
+
+void debugOTP(uint8_t * COG_data, uint16_t size, uint8_t COG, uint8_t driver)
+{
+    ;
+}
+//
+// === End of Serial and log
+//
+
+//
+// === GPIO
+//
+void hV_HAL_GPIO_define(uint8_t pin, uint8_t mode)
+{
+    if (mode != OUTPUT)
+    {
+        levels[pin] = HIGH; // Pull-up
+    }
+}
+
+void hV_HAL_GPIO_set(uint8_t pin)
+{
+    levels[pin] = HIGH;
+}
+
+void hV_HAL_GPIO_clear(uint8_t pin)
+{
+    levels[pin] = LOW;
+
+    // /RESET wakes the touch controller up
+    if (pin == pins.touchReset)
+    {
+        flagTouchSleep = false;
+    }
+}
+
+uint8_t hV_HAL_GPIO_get(uint8_t pin)
+{
+    if (pin == pins.panelBusy)
+    {
+        return (clockNow >= busyUntil) ? HIGH : LOW;
+    }
+    else if (pin == pins.touchInt)
+    {
+        return (getContact() != nullptr) ? LOW : HIGH;
+    }
+    return levels[pin];
+}
+//
+// === End of GPIO
+//
+
+//
+// === SPI
+//
+void hV_HAL_SPI_begin(uint32_t speed)
+{
+    speedSPI = speed;
+}
+
+void hV_HAL_SPI_end()
+{
+    ;
+}
+
+uint8_t hV_HAL_SPI_transfer(uint8_t data)
+{
+    advance(8000000000ULL / speedSPI);
+
+    if (speedSPI > speedLimit) // Signal integrity
+    {
+        return 0x00;
+    }
+
+    if (levels[pins.panelDC] == LOW) // Command
+    {
+        panelCommand = data;
+        panelData = 0;
+
+        switch (data)
+        {
+            case 0x04: // Power on
+
+                busyUntil = clockNow + (uint64_t)PANEL_POWER_ON * 1000000;
+                break;
+
+            case 0x12: // Display refresh
+
+                busyUntil = clockNow + (uint64_t)(flagFast ? PANEL_REFRESH_FAST : PANEL_REFRESH_NORMAL) * 1000000;
+                break;
+
+            case 0x02: // Turn off DC/DC
+
+                busyUntil = clockNow + (uint64_t)PANEL_POWER_OFF * 1000000;
+                break;
+
+            default:
+
+                break;
+        }
+    }
+    else // Data
+    {
+        if ((panelCommand == 0x00) and (panelData == 0) and (data == 0x0e)) // Soft-reset
+        {
+            busyUntil = clockNow + (uint64_t)PANEL_SOFT_RESET * 1000000;
+        }
+        else if ((panelCommand == 0xe5) and (panelData == 0)) // Temperature
+        {
+            flagFast = ((data & 0x40) > 0);
+        }
+        panelData += 1;
+    }
+    return 0x00;
+}
+
+void hV_HAL_SPI3_begin()
+{
+    otpIndex = 0;
+}
+
+void hV_HAL_SPI3_end()
+{
+    ;
+}
+
+void hV_HAL_SPI3_write(uint8_t data)
+{
+    advance(SPI3_BYTE_NS);
+    otpIndex = 0;
+}
+
+uint8_t hV_HAL_SPI3_read()
+{
+    advance(SPI3_BYTE_NS);
+
+    // Dummy, then OTP from index 0, bank 0
+    uint8_t value = 0x00;
+    if (otpIndex == 1)
+    {
+        value = 0xa5;
+    }
+    else if (otpIndex == otpPSR + 1)
+    {
+        value = 0xcf; // PSR0
+    }
+    else if (otpIndex == otpPSR + 2)
+    {
+        value = 0x82; // PSR1
+    }
+    otpIndex += 1;
+    return value;
+}
+//
+// === End of SPI
+//
+
+//
+// === Wire
+//
+void hV_HAL_Wire_begin()
+{
+    ;
+}
+
+void hV_HAL_Wire_end()
+{
+    ;
+}
+
+uint8_t hV_HAL_Wire_transfer(uint8_t address, uint8_t * dataWrite, size_t sizeWrite, uint8_t * dataRead, size_t sizeRead)
+{
+    advance((uint64_t)(1 + sizeWrite + ((sizeRead > 0) ? 1 + sizeRead : 0)) * WIRE_BYTE_NS);
+
+    if (address != touchAddress)
+    {
+        return RESULT_ERROR;
+    }
+
+    for (size_t index = 0; index < sizeRead; index += 1)
+    {
+        dataRead[index] = 0x00;
+    }
+
+    const contact_t * contact = getContact();
+    uint8_t command = (sizeWrite > 0) ? dataWrite[0] : 0xff;
+
+    if (address == 0x41) // 2.71"
+    {
+        if (command == 0x30) // Sleep
+        {
+            flagTouchSleep = true;
+        }
+        else if ((command == 0x10) and (sizeRead >= 1)) // Number of contacts
+        {
+            dataRead[0] = (contact != nullptr) ? 1 : 0;
+        }
+        else if ((command == 0x11) and (sizeRead >= 5)) // Report
+        {
+            if (contact != nullptr)
+            {
+                dataRead[0] = 0x80;
+                dataRead[1] = contact->x >> 8;
+                dataRead[2] = contact->x;
+                dataRead[3] = contact->y >> 8;
+                dataRead[4] = contact->y;
+            }
+        }
+    }
+    else // 0x38, 3.70"
+    {
+        if ((command == 0xa5) and (sizeWrite >= 2)) // Power mode
+        {
+            flagTouchSleep = (dataWrite[1] == 0x03); // Hibernate
+        }
+        else if ((command == 0x00) and (sizeRead >= 7)) // Report
+        {
+            if (contact != nullptr)
+            {
+                dataRead[2] = 1; // Number of contacts
+                dataRead[3] = 0x80 | (contact->x >> 8); // Contact
+                dataRead[4] = contact->x;
+                dataRead[5] = 0x00 | (contact->y >> 8); // Identifier 0
+                dataRead[6] = contact->y;
+            }
+            else
+            {
+                for (size_t index = 3; index < 7; index += 1)
+                {
+                    dataRead[index] = 0xff; // Identifier 0x0f, no contact
+                }
+            }
+        }
+    }
+    return RESULT_SUCCESS;
+}
+//
+// === End of Wire
+//
+
+//
+// === Time
+//
+void hV_HAL_delayMilliseconds(uint32_t ms)
+{
+    advance((uint64_t)ms * 1000000);
+}
+
+void hV_HAL_delayMicroseconds(uint32_t us)
+{
+    advance((uint64_t)us * 1000);
+}
+
+uint32_t hV_HAL_getMilliseconds()
+{
+    return clockNow / 1000000;
+}
+
+uint32_t hV_HAL_getMicroseconds()
+{
+    return clockNow / 1000;
+}
+//
+// === End of Time
+//
+
+//
+// === Board
+//
+void Driver_EPD_Virtual::b_begin(pins_t board, uint8_t family, uint16_t delayCS)
+{
+    b_pin = board;
+    b_delayCS = delayCS;
+}
+
+void Driver_EPD_Virtual::b_reset(uint32_t ms1, uint32_t ms2, uint32_t ms3, uint32_t ms4, uint32_t ms5)
+{
+    hV_HAL_delayMilliseconds(ms1);
+    hV_HAL_GPIO_set(b_pin.panelReset);
+    hV_HAL_delayMilliseconds(ms2);
+    hV_HAL_GPIO_clear(b_pin.panelReset);
+    hV_HAL_delayMilliseconds(ms3);
+    hV_HAL_GPIO_set(b_pin.panelReset);
+    hV_HAL_delayMilliseconds(ms4);
+    hV_HAL_GPIO_set(b_pin.panelCS);
+    hV_HAL_delayMilliseconds(ms5);
+}
+
+void Driver_EPD_Virtual::b_waitBusy(bool state)
+{
+    // Jump to BUSY released, interrupt edges on the way
+    if ((state == HIGH) and (clockNow < busyUntil))
+    {
+        advance(busyUntil - clockNow);
+    }
+}
+
+void Driver_EPD_Virtual::b_suspend(uint8_t suspendScope)
+{
+    b_fsmPowerScreen = FSM_OFF;
+}
+
+void Driver_EPD_Virtual::b_resume()
+{
+    if (b_fsmPowerScreen != FSM_ON)
+    {
+        hV_HAL_GPIO_define(b_pin.panelBusy, INPUT);
+        hV_HAL_GPIO_define(b_pin.panelDC, OUTPUT);
+        hV_HAL_GPIO_define(b_pin.panelReset, OUTPUT);
+        hV_HAL_GPIO_define(b_pin.panelCS, OUTPUT);
+        hV_HAL_GPIO_set(b_pin.panelCS);
+        b_fsmPowerScreen = FSM_ON;
+    }
+}
+
+void Driver_EPD_Virtual::b_sendCommand8(uint8_t command)
+{
+    hV_HAL_GPIO_clear(b_pin.panelDC); // DC Low = Command
+    hV_HAL_GPIO_clear(b_pin.panelCS); // CS Low = Select
+    hV_HAL_delayMicroseconds(b_delayCS);
+    hV_HAL_SPI_transfer(command);
+    hV_HAL_delayMicroseconds(b_delayCS);
+    hV_HAL_GPIO_set(b_pin.panelCS); // CS High = Unselect
+}
+
+void Driver_EPD_Virtual::b_sendCommandData8(uint8_t command, uint8_t data)
+{
+    b_sendIndexFixed(command, data, 1);
+}
+
+void Driver_EPD_Virtual::b_sendIndexData(uint8_t index, const uint8_t * data, uint32_t size)
+{
+    hV_HAL_GPIO_clear(b_pin.panelDC); // DC Low = Command
+    hV_HAL_GPIO_clear(b_pin.panelCS); // CS Low = Select
+    hV_HAL_delayMicroseconds(b_delayCS);
+    hV_HAL_SPI_transfer(index);
+    hV_HAL_delayMicroseconds(b_delayCS);
+    hV_HAL_GPIO_set(b_pin.panelDC); // DC High = Data
+    for (uint32_t i = 0; i < size; i += 1)
+    {
+        hV_HAL_SPI_transfer(data[i]);
+    }
+    hV_HAL_delayMicroseconds(b_delayCS);
+    hV_HAL_GPIO_set(b_pin.panelCS); // CS High = Unselect
+}
+
+void Driver_EPD_Virtual::b_sendIndexFixed(uint8_t index, uint8_t data, uint32_t size)
+{
+    hV_HAL_GPIO_clear(b_pin.panelDC); // DC Low = Command
+    hV_HAL_GPIO_clear(b_pin.panelCS); // CS Low = Select
+    hV_HAL_delayMicroseconds(b_delayCS);
+    hV_HAL_SPI_transfer(index);
+    hV_HAL_delayMicroseconds(b_delayCS);
+    hV_HAL_GPIO_set(b_pin.panelDC); // DC High = Data
+    for (uint32_t i = 0; i < size; i += 1)
+    {
+        hV_HAL_SPI_transfer(data);
+    }
+    hV_HAL_delayMicroseconds(b_delayCS);
+    hV_HAL_GPIO_set(b_pin.panelCS); // CS High = Unselect
+}
+//
+// === End of Board
+//
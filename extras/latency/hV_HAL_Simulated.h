@@ -0,0 +1,64 @@
+//
+// hV_HAL_Simulated.h
+// Simulated board and touch controller for the latency harness
+// ----------------------------------
+//
+// Project Pervasive Displays Library Suite
+// Based on highView technology
+//
+// Copyright (c) Pervasive Displays Inc., 2021-2026
+// Licence All rights reserved
+//
+// Virtual clock, advanced by delays, SPI and I2C transfers and BUSY waits
+// Panel BUSY timing decoded from the SPI commands
+// Touch controller driven by a script of contacts
+//
+
+#ifndef HV_HAL_SIMULATED_RELEASE
+#define HV_HAL_SIMULATED_RELEASE 910
+
+#include "PDLS_Common.h"
+
+///
+/// @brief Scripted contact
+///
+struct contact_t
+{
+    uint32_t down; ///< ms, finger down
+    uint32_t up; ///< ms, finger up
+    uint16_t x; ///< native x-axis
+    uint16_t y; ///< native y-axis
+};
+
+///
+/// @brief Start simulation
+///
+/// @param pins board configuration, BUSY, DC, CS and touch INT are simulated
+/// @param touchAddress 0x41 for 2.71", 0x38 for 3.70"
+/// @param contacts script, sorted by down time
+/// @param number number of contacts
+///
+void simulated_begin(pins_t pins, uint8_t touchAddress, const contact_t * contacts, uint32_t number);
+
+///
+/// @brief Attach the interrupt service routine of the touch INT falling edge
+///
+/// @param isr called from the virtual clock when a contact starts
+///
+void simulated_attachInterrupt(void (*isr)());
+
+///
+/// @brief Set highest SPI clock received by the panel
+///
+/// @param speed clock in Hz, bytes sent above are lost, default 16 MHz
+///
+void simulated_setSpeedLimit(uint32_t speed);
+
+///
+/// @brief Set log level
+///
+/// @param level LEVEL_CRITICAL to LEVEL_DEBUG, messages above are discarded
+///
+void simulated_setLogLevel(uint8_t level);
+
+#endif // HV_HAL_SIMULATED_RELEASE
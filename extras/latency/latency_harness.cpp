@@ -0,0 +1,435 @@
+//
+// latency_harness.cpp
+// Host harness for touch-to-glass latency
+// ----------------------------------
+//
+// Project Pervasive Displays Library Suite
+// Based on highView technology
+//
+// Copyright (c) Pervasive Displays Inc., 2021-2026
+// Licence All rights reserved
+//
+// Runs Pervasive_Touch_Small against hV_HAL_Simulated.cpp with a script of contacts.
+// Each press triggers a fast update, as a GUI button would.
+// Reports latency percentiles and the mean duration of each phase.
+//
+// Script  one contact per line, down and up in ms, x and y in native coordinates
+//         lines starting with # are ignored
+//         without script, one tap every 1.5 s to 4.5 s on a fixed pseudo-random sequence
+//
+// Example
+//   make
+//   ./latency_harness --size 370 --poll 20 200 --count 500
+//   ./latency_harness --size 271 --script taps.txt --replay
+//   ./latency_harness --size 370 --poll 1 1 --replay --replay-poll 20 200
+//   ./latency_harness --size 370 --calibrate 10000000
+//   ./latency_harness --size 370 --bench 100
+//
+// Replay  records the run, then replays the trace at recorded speed through the touch parser
+//         with the same updates, polling as the run or as set by --replay-poll
+//
+// Bench   CoG initialisation from the command lists against a baseline
+//         with the same commands sent one CS frame each
+//
+
+#include "hV_HAL_Simulated.h"
+#include "Pervasive_Touch_Small.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+///
+/// @brief Driver with the CoG initialisation as sent before command lists, for --bench
+///
+class Bench_Touch_Small : public Pervasive_Touch_Small
+{
+  public:
+
+    using Pervasive_Touch_Small::Pervasive_Touch_Small;
+
+    ///
+    /// @brief CoG initialisation with one CS frame per command
+    ///
+    /// @param updateMode UPDATE_NORMAL or UPDATE_FAST
+    /// @return uint32_t time in us, from soft-reset to last initial command
+    ///
+    uint32_t getInitialBaseline(uint8_t updateMode)
+    {
+        uint8_t index00_work[2] = {0x00, 0x00}; // PSR, timing only
+
+        b_resume();
+        uint32_t chrono = hV_HAL_getMicroseconds();
+        b_sendCommandData8(0x00, 0x0e); // Soft-reset
+        b_waitBusy();
+        b_sendCommandData8(0xe5, (updateMode == UPDATE_FAST) ? u_temperature | 0x40 : u_temperature); // Input Temperature
+        b_sendCommandData8(0xe0, 0x02); // Activate Temperature
+        b_sendIndexData(0x00, index00_work, 2); // PSR
+        if (updateMode == UPDATE_FAST)
+        {
+            b_sendCommandData8(0x50, 0x07); // Vcom and data interval setting
+        }
+        return hV_HAL_getMicroseconds() - chrono;
+    }
+};
+
+static Pervasive_Touch_Small * screen = nullptr;
+
+static void touchISR()
+{
+    screen->stampInterrupt();
+}
+
+static bool readScript(const char * path, std::vector<contact_t> & contacts)
+{
+    FILE * file = fopen(path, "r");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    char line[128];
+    while (fgets(line, sizeof(line), file) != nullptr)
+    {
+        contact_t contact;
+        if ((line[0] != '#') and (sscanf(line, "%u %u %hu %hu", &contact.down, &contact.up, &contact.x, &contact.y) == 4))
+        {
+            contacts.push_back(contact);
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+static void generateScript(uint32_t count, uint16_t sizeX, uint16_t sizeY, std::vector<contact_t> & contacts)
+{
+    uint32_t seed = 0x2545f491;
+    uint32_t chrono = 1000;
+
+    for (uint32_t index = 0; index < count; index += 1)
+    {
+        seed = seed * 1664525 + 1013904223;
+        contact_t contact;
+        contact.down = chrono;
+        contact.up = chrono + 60 + (seed >> 24); // 60 to 315 ms
+        contact.x = (seed >> 8) % sizeX;
+        contact.y = (seed >> 16) % sizeY;
+        contacts.push_back(contact);
+        chrono += 1500 + (seed % 3000);
+    }
+}
+
+static uint64_t phases[STAMP_NUMBER] = {0};
+static uint32_t phaseCounts[STAMP_NUMBER] = {0};
+static std::vector<uint32_t> latencies; // From interrupt stamp
+static std::vector<uint32_t> latenciesContact; // From scripted finger down
+
+static uint32_t getPercentile(std::vector<uint32_t> values, uint8_t percentile)
+{
+    std::sort(values.begin(), values.end());
+    size_t rank = (values.size() * percentile + 99) / 100; // Nearest rank
+    return values[(rank > 0) ? rank - 1 : 0];
+}
+
+static uint32_t runScript(Pervasive_Touch_Small & driver, uint32_t duration,
+                          std::vector<uint8_t> & frame1, std::vector<uint8_t> & frame2,
+                          const std::vector<contact_t> * contacts)
+{
+    uint32_t presses = 0;
+    size_t contact = 0;
+    uint32_t start = hV_HAL_getMilliseconds();
+
+    while (hV_HAL_getMilliseconds() - start < duration)
+    {
+        touch_t touch = {0};
+
+        if (driver.pollTouch(touch) and (touch.t == TOUCH_EVENT_PRESS))
+        {
+            presses += 1;
+
+            // Contact pressed, last one down
+            uint32_t chrono = hV_HAL_getMilliseconds();
+            while ((contacts != nullptr) and (contact + 1 < contacts->size()) and ((*contacts)[contact + 1].down <= chrono))
+            {
+                contact += 1;
+            }
+
+            driver.updateFast(frame1.data(), frame2.data(), frame1.size());
+            frame1.swap(frame2);
+
+            if (driver.getStamp(STAMP_INTERRUPT) > 0)
+            {
+                latencies.push_back(driver.getStamp(STAMP_DCDC) - driver.getStamp(STAMP_INTERRUPT)); // BUSY released
+            }
+            if (contacts != nullptr)
+            {
+                latenciesContact.push_back(driver.getStamp(STAMP_DCDC) - (*contacts)[contact].down);
+            }
+
+            // Phase = from stamp to next reached stamp
+            uint8_t previous = STAMP_NUMBER;
+            for (uint8_t stamp = 0; stamp < STAMP_NUMBER; stamp += 1)
+            {
+                uint32_t chrono = driver.getStamp(stamp);
+                if (chrono == 0)
+                {
+                    continue;
+                }
+                if (previous < STAMP_NUMBER)
+                {
+                    phases[previous] += chrono - driver.getStamp(previous);
+                    phaseCounts[previous] += 1;
+                }
+                previous = stamp;
+            }
+        }
+        else
+        {
+            hV_HAL_delayMilliseconds(1);
+        }
+    }
+    return presses;
+}
+
+int main(int argc, char * argv[])
+{
+    uint16_t size = 370;
+    uint16_t pollActive = 20;
+    uint16_t pollIdle = 200;
+    uint32_t count = 200;
+    const char * pathScript = nullptr;
+    bool flagISR = true;
+    bool flagReplay = false;
+    uint16_t replayActive = 0; // 0 = as the run
+    uint16_t replayIdle = 0;
+    uint32_t speedLimit = 0;
+    uint32_t bench = 0;
+
+    for (int index = 1; index < argc; index += 1)
+    {
+        if ((strcmp(argv[index], "--size") == 0) and (index + 1 < argc))
+        {
+            size = atoi(argv[++index]);
+        }
+        else if ((strcmp(argv[index], "--poll") == 0) and (index + 2 < argc))
+        {
+            pollActive = atoi(argv[++index]);
+            pollIdle = atoi(argv[++index]);
+        }
+        else if ((strcmp(argv[index], "--count") == 0) and (index + 1 < argc))
+        {
+            count = atoi(argv[++index]);
+        }
+        else if ((strcmp(argv[index], "--script") == 0) and (index + 1 < argc))
+        {
+            pathScript = argv[++index];
+        }
+        else if (strcmp(argv[index], "--no-isr") == 0)
+        {
+            flagISR = false;
+        }
+        else if (strcmp(argv[index], "--replay") == 0)
+        {
+            flagReplay = true;
+        }
+        else if ((strcmp(argv[index], "--replay-poll") == 0) and (index + 2 < argc))
+        {
+            flagReplay = true;
+            replayActive = atoi(argv[++index]);
+            replayIdle = atoi(argv[++index]);
+        }
+        else if ((strcmp(argv[index], "--calibrate") == 0) and (index + 1 < argc))
+        {
+            speedLimit = atoi(argv[++index]);
+        }
+        else if ((strcmp(argv[index], "--bench") == 0) and (index + 1 < argc))
+        {
+            bench = atoi(argv[++index]);
+        }
+        else if (strcmp(argv[index], "--verbose") == 0)
+        {
+            simulated_setLogLevel(LEVEL_DEBUG);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--size 271|370] [--poll active idle] [--count n] [--script file] [--no-isr] [--replay] [--replay-poll active idle] [--calibrate limit_Hz] [--bench n] [--verbose]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (replayActive == 0)
+    {
+        replayActive = pollActive;
+        replayIdle = pollIdle;
+    }
+
+    // Screen
+    eScreen_EPD_t eScreen;
+    uint16_t sizeX;
+    uint16_t sizeY;
+    uint8_t address;
+
+    if (size == 271)
+    {
+        eScreen = eScreen_EPD_271_KS_09_Touch;
+        sizeX = 176;
+        sizeY = 264;
+        address = 0x41;
+    }
+    else if (size == 370)
+    {
+        eScreen = eScreen_EPD_370_KS_0C_Touch;
+        sizeX = 240;
+        sizeY = 416;
+        address = 0x38;
+    }
+    else
+    {
+        fprintf(stderr, "Size %u not supported, 271 or 370\n", size);
+        return 1;
+    }
+
+    // Script
+    std::vector<contact_t> contacts;
+    if (pathScript != nullptr)
+    {
+        if (readScript(pathScript, contacts) == false)
+        {
+            fprintf(stderr, "Script %s not found\n", pathScript);
+            return 1;
+        }
+    }
+    else
+    {
+        generateScript(count, sizeX, sizeY, contacts);
+    }
+    if (contacts.empty())
+    {
+        fprintf(stderr, "Script empty\n");
+        return 1;
+    }
+
+    // Board
+    pins_t pins = {0};
+    pins.panelBusy = 1;
+    pins.panelDC = 2;
+    pins.panelReset = 3;
+    pins.panelCS = 4;
+    pins.touchInt = 5;
+    pins.touchReset = 6;
+
+    simulated_begin(pins, address, contacts.data(), contacts.size());
+
+    Bench_Touch_Small driver(eScreen, pins);
+    screen = &driver;
+    if (flagISR)
+    {
+        simulated_attachInterrupt(touchISR);
+    }
+
+    driver.begin();
+    driver.setTouchPolling(pollActive, pollIdle);
+
+    // SPI clock calibrated against a panel losing commands above the limit
+    if (speedLimit > 0)
+    {
+        simulated_setSpeedLimit(speedLimit);
+        driver.calibrateSpeedSPI();
+        printf("SPI       limit %u Hz, calibrated %u Hz, %u bytes/s\n", speedLimit, driver.getSpeedSPI(), driver.getThroughputSPI());
+    }
+
+    uint32_t sizeFrame = (uint32_t)sizeX * sizeY / 8;
+    std::vector<uint8_t> frame1(sizeFrame, 0x00);
+    std::vector<uint8_t> frame2(sizeFrame, 0xff);
+
+    // Fixed overhead per update, CoG initialisation and whole update
+    if (bench > 0)
+    {
+        for (uint8_t mode = UPDATE_NORMAL; mode <= UPDATE_FAST; mode += 1)
+        {
+            std::vector<uint32_t> initials;
+            std::vector<uint32_t> updates;
+
+            for (uint32_t index = 0; index < bench; index += 1)
+            {
+                if (mode == UPDATE_NORMAL)
+                {
+                    driver.updateNormal(frame1.data(), sizeFrame);
+                }
+                else
+                {
+                    driver.updateFast(frame1.data(), frame2.data(), sizeFrame);
+                }
+                frame1.swap(frame2);
+                initials.push_back(driver.getInitialDuration());
+                updates.push_back(driver.getStamp(STAMP_END) - driver.getStamp(STAMP_SUBMIT));
+            }
+
+            // Same commands, one CS frame each
+            uint32_t baseline = driver.getInitialBaseline(mode);
+
+            printf("Bench     %-6s initial p50 %u us, p99 %u us, baseline %u us, update p50 %u ms, %u updates\n", (mode == UPDATE_NORMAL) ? "normal" : "fast",
+                   getPercentile(initials, 50), getPercentile(initials, 99), baseline, getPercentile(updates, 50), bench);
+        }
+        return 0;
+    }
+
+    std::vector<uint8_t> trace(16 * 1024 * 1024);
+    if (flagReplay)
+    {
+        driver.beginTouchRecord(trace.data(), trace.size());
+    }
+
+    // Run, one press = one fast update
+    uint32_t duration = contacts.back().up + 2000;
+    uint32_t presses = runScript(driver, duration, frame1, frame2, &contacts);
+
+    // Report
+    static const char * stringStamp[STAMP_NUMBER] =
+    {
+        "interrupt", "touch", "submit", "reset", "OTP", "initial",
+        "data", "power", "refresh", "DC/DC", "end"
+    };
+
+    printf("Screen    %u, touch 0x%02x, poll %u / %u ms, ISR %s\n", size, address, pollActive, pollIdle, flagISR ? "yes" : "no");
+    printf("Contacts  %u, presses %u, updates %u\n", (uint32_t)contacts.size(), presses, driver.getLatencyCount());
+    printf("Latency   p50 %u ms, p95 %u ms, p99 %u ms, driver estimate\n", driver.getLatencyPercentile(50), driver.getLatencyPercentile(95), driver.getLatencyPercentile(99));
+    if (latencies.size() > 0)
+    {
+        printf("Latency   p50 %u ms, p95 %u ms, p99 %u ms, from interrupt stamp\n", getPercentile(latencies, 50), getPercentile(latencies, 95), getPercentile(latencies, 99));
+    }
+    if (latenciesContact.size() > 0)
+    {
+        printf("Latency   p50 %u ms, p95 %u ms, p99 %u ms, from finger down\n", getPercentile(latenciesContact, 50), getPercentile(latenciesContact, 95), getPercentile(latenciesContact, 99));
+    }
+    printf("Polls     %u per minute, I2C %u per minute\n", driver.getTouchPollsPerMinute(), driver.getTouchTransactionsPerMinute());
+    printf("Phases    mean ms, from stamp\n");
+    for (uint8_t stamp = 0; stamp < STAMP_NUMBER; stamp += 1)
+    {
+        if (phaseCounts[stamp] > 0)
+        {
+            printf("  %-10s %8.1f\n", stringStamp[stamp], (double)phases[stamp] / phaseCounts[stamp]);
+        }
+    }
+
+    // Same updates again at recorded speed, parser results checked against the recorded events
+    if (flagReplay)
+    {
+        uint32_t sizeTrace = driver.endTouchRecord();
+
+        driver.setTouchPolling(replayActive, replayIdle);
+        driver.beginTouchReplay(trace.data(), sizeTrace, 1);
+        uint32_t pressesReplay = runScript(driver, duration, frame1, frame2, nullptr);
+        uint32_t mismatches = driver.endTouchReplay();
+
+        printf("Replay    trace %u bytes, poll %u / %u ms, presses %u, mismatches %u\n", sizeTrace, replayActive, replayIdle, pressesReplay, mismatches);
+        if ((mismatches > 0) or (pressesReplay != presses))
+        {
+            return 2;
+        }
+    }
+
+    return 0;
+}
@@ -47,6 +47,21 @@
 // Release 902: Simplified touch options
 // Release 909: Added I2C device availability check
 // Release 909: Improved stability for 3.70 touch
+// Release 910: Added grey-level frames with on-the-fly packing
+// Release 910: Added frame orientation with rotation during transmission
+// Release 910: Added frame assets store
+// Release 910: Added time stamps and touch-to-glass latency
+// Release 910: Added touch trace record and replay
+// Release 910: Added SPI clock calibration
+// Release 910: Added fingerprint to skip redundant updates
+// Release 910: Added touch filter
+// Release 910: Added touch regions with grid index
+// Release 910: Added adaptive touch polling
+// Release 910: Added touch suspend and resume with wake-on-touch
+// Release 910: Added power policy between updates
+// Release 910: Added energy model
+// Release 910: Added temperature provider with cache
+// Release 910: Added command lists for CoG initialisation
 //
 
 // Header
@@ -78,6 +93,13 @@
 //
 // --- Small screens with Q film
 //
+// Command list, entry = flags | length, command, data
+#define LIST_WAIT 0x80 // Wait for BUSY after command
+#define LIST_END 0x40 // End of list
+#define LIST_LENGTH 0x0f // Number of data bytes, up to 15
+#define LIST_INDEX_TEMPERATURE 5 // Temperature in COG_initial() lists
+#define LIST_INDEX_PSR 11 // PSR in COG_initial() lists
+
 void Pervasive_Touch_Small::COG_reset()
 {
     // Application note § 2. Power on COG driver
@@ -348,33 +370,43 @@ void Pervasive_Touch_Small::COG_initial(uint8_t updateMode)
                 index00_work[1] = COG_data[1]; // PSR1
             } // u_codeExtra updateMode
 
-            // New algorithm
-            b_sendCommandData8(0x00, 0x0e); // Soft-reset
-            b_waitBusy();
-
-            b_sendCommandData8(0xe5, indexTemperature); // Input Temperature
-            b_sendCommandData8(0xe0, 0x02); // Activate Temperature
-
-            switch (u_eScreen_EPD)
+            // New algorithm, as a single command list
+            // Templates, only temperature and PSR patched
+            static const uint8_t listNormal[] =
             {
-                // case eScreen_EPD_290_KS_0F: // No PSR
-                //
-                //     b_sendCommandData8(0x4d, 0x55);
-                //     b_sendCommandData8(0xe9, 0x02);
-                //     break;
-
-                default:
-
-                    b_sendIndexData(0x00, index00_work, 2); // PSR
-                    break;
-            }
+                LIST_WAIT | 1, 0x00, 0x0e, // Soft-reset
+                1, 0xe5, 0x00, // Input Temperature
+                1, 0xe0, 0x02, // Activate Temperature
+                2, 0x00, 0x00, 0x00, // PSR
+                LIST_END
+            };
+            static const uint8_t listFast[] =
+            {
+                LIST_WAIT | 1, 0x00, 0x0e, // Soft-reset
+                1, 0xe5, 0x00, // Input Temperature
+                1, 0xe0, 0x02, // Activate Temperature
+                2, 0x00, 0x00, 0x00, // PSR
+                1, 0x50, 0x07, // Vcom and data interval setting
+                LIST_END
+            };
 
             // Specific settings for fast update, all screens
             // FILM_K already checked
-            if (updateMode != UPDATE_NORMAL)
+            const uint8_t * listTemplate = (updateMode == UPDATE_NORMAL) ? listNormal : listFast;
+            uint8_t sizeList = (updateMode == UPDATE_NORMAL) ? sizeof(listNormal) : sizeof(listFast);
+            uint8_t list[sizeof(listFast)];
+
+            for (uint8_t index = 0; index < sizeList; index += 1)
             {
-                b_sendCommandData8(0x50, 0x07); // Vcom and data interval setting
+                list[index] = listTemplate[index];
             }
+            list[LIST_INDEX_TEMPERATURE] = indexTemperature;
+            list[LIST_INDEX_PSR] = index00_work[0];
+            list[LIST_INDEX_PSR + 1] = index00_work[1];
+
+            uint32_t chrono = hV_HAL_getMicroseconds();
+            COG_sendList(list);
+            d_initialDuration = hV_HAL_getMicroseconds() - chrono;
             break;
     }
 }
@@ -403,8 +435,8 @@ void Pervasive_Touch_Small::COG_sendImageDataFast(FRAMEBUFFER_CONST_TYPE frame1,
                 b_sendCommandData8(0x50, 0x27); // Vcom and data interval setting
             }
 
-            b_sendIndexData(0x10, previousBuffer, sizeFrame); // First frame, blackBuffer
-            b_sendIndexData(0x13, nextBuffer, sizeFrame); // Second frame, 0x00
+            COG_sendIndexFrame(0x10, previousBuffer, sizeFrame); // First frame, blackBuffer
+            COG_sendIndexFrame(0x13, nextBuffer, sizeFrame); // Second frame, 0x00
 
             // Additional settings for fast update, 154 213 266 370 and 437 screens (s_flag50)
             if (s_flag50)
@@ -431,7 +463,7 @@ void Pervasive_Touch_Small::COG_sendImageDataNormal(FRAMEBUFFER_CONST_TYPE frame
 
         default:
 
-            b_sendIndexData(0x10, frame, sizeFrame); // First frame, blackBuffer
+            COG_sendIndexFrame(0x10, frame, sizeFrame); // First frame, blackBuffer
             b_sendIndexFixed(0x13, 0x00, sizeFrame); // Second frame, 0x00
             break;
     } // u_eScreen_EPD
@@ -454,8 +486,10 @@ void Pervasive_Touch_Small::COG_update()
         default:
 
             b_waitBusy();
+            d_stamp(STAMP_POWER);
             b_sendCommand8(0x04); // Power on
             b_waitBusy();
+            d_stamp(STAMP_REFRESH);
             b_sendCommand8(0x12); // Display Refresh
             b_waitBusy();
             break;
@@ -473,10 +507,58 @@ void Pervasive_Touch_Small::COG_stopDCDC()
         //     break;
 
         default:
+        {
+            static const uint8_t list[] =
+            {
+                LIST_WAIT | 0, 0x02, // Turn off DC/DC
+                LIST_END
+            };
+
+            COG_sendList(list);
+        }
+        break;
+    }
+}
+
+void Pervasive_Touch_Small::COG_sendList(const uint8_t * list)
+{
+    // One CS frame per run of commands, closed before BUSY and at the end
+    // DC selects command or data within the frame, b_delayCS only at CS edges
+    bool flagSelected = false;
+
+    while ((list[0] & LIST_END) == 0)
+    {
+        uint8_t length = list[0] & LIST_LENGTH;
+
+        if (flagSelected == false)
+        {
+            COG_selectIndex(list[1]);
+            flagSelected = true;
+        }
+        else
+        {
+            hV_HAL_GPIO_clear(b_pin.panelDC); // DC Low = Command
+            hV_HAL_SPI_transfer(list[1]);
+            hV_HAL_GPIO_set(b_pin.panelDC); // DC High = Data
+        }
+
+        for (uint8_t index = 0; index < length; index += 1)
+        {
+            hV_HAL_SPI_transfer(list[2 + index]);
+        }
+
+        bool flagWait = ((list[0] & LIST_WAIT) > 0);
+        list += 2 + length;
 
-            b_sendCommand8(0x02); // Turn off DC/DC
+        if (flagWait or (list[0] & LIST_END))
+        {
+            COG_unselect();
+            flagSelected = false;
+        }
+        if (flagWait)
+        {
             b_waitBusy();
-            break;
+        }
     }
 }
 //
@@ -492,6 +574,22 @@ Pervasive_Touch_Small::Pervasive_Touch_Small(eScreen_EPD_t eScreen_EPD, pins_t b
     d_COG = COG_TOUCH_SMALL;
     u_eScreen_EPD = eScreen_EPD;
     b_pin = board;
+
+    // Native scan order, x-axis = source lines, y-axis = gate lines
+    switch (SCREEN_SIZE(u_eScreen_EPD))
+    {
+        case SIZE_370:
+
+            s_sizeX = 240;
+            s_sizeY = 416;
+            break;
+
+        default: // SIZE_271
+
+            s_sizeX = 176;
+            s_sizeY = 264;
+            break;
+    }
 }
 
 void Pervasive_Touch_Small::begin()
@@ -519,231 +617,2026 @@ STRING_CONST_TYPE Pervasive_Touch_Small::reference()
     return formatString("%s v%i.%i.%i", DRIVER_EPD_VARIANT, DRIVER_EPD_RELEASE / 100, (DRIVER_EPD_RELEASE / 10) % 10, DRIVER_EPD_RELEASE % 10);
 }
 
-void Pervasive_Touch_Small::updateNormal(FRAMEBUFFER_CONST_TYPE frame, uint32_t sizeFrame)
+void Pervasive_Touch_Small::d_beginUpdate(uint8_t updateMode)
 {
+    // Pending touch is served by this update
+    for (uint8_t stamp = 0; stamp < STAMP_NUMBER; stamp += 1)
+    {
+        d_stamps[stamp] = 0;
+    }
+    // Read and clear in a row, d_stampInterrupt may be set from ISR
+    d_stamps[STAMP_INTERRUPT] = d_stampInterrupt;
+    d_stampInterrupt = 0;
+    d_stamps[STAMP_TOUCH] = d_stampTouch;
+    d_stampTouch = 0;
+    d_stamp(STAMP_SUBMIT);
+    s_updateMode = updateMode;
+
+    // Average period between updates
+    uint32_t chrono = hV_HAL_getMilliseconds();
+    if (s_updateLast > 0)
+    {
+        uint32_t period = chrono - s_updateLast;
+        s_updatePeriod = (s_updatePeriod == 0) ? period : (s_updatePeriod * 3 + period) / 4;
+    }
+    s_updateLast = (chrono > 0) ? chrono : 1;
+
+    // Peripherals still on, b_resume() checks the power state and returns
+    if (b_fsmPowerScreen == FSM_ON)
+    {
+        s_policyAvoided += 1;
+    }
     b_resume(); // GPIO
+    d_stamp(STAMP_RESET);
     COG_reset(); // Reset
 
     if (u_flagOTP == false)
     {
+        d_stamp(STAMP_OTP);
         COG_getDataOTP(); // 3-wire SPI read OTP memory
         COG_reset(); // Reset
     }
 
     // Start SPI
-    hV_HAL_SPI_begin(16000000); // Fast 16 MHz, with unicity check
+    hV_HAL_SPI_begin(s_speedSPI); // Fast 16 MHz or calibrated, with unicity check
 
-    COG_initial(UPDATE_NORMAL); // Initialise
-    COG_sendImageDataNormal(frame, sizeFrame);
+    d_stamp(STAMP_INITIAL);
+    d_refreshTemperature(); // Cached
+    COG_initial(updateMode); // Initialise
+    d_stamp(STAMP_DATA);
+}
 
+void Pervasive_Touch_Small::d_endUpdate()
+{
     COG_update(); // Update
+    d_stamp(STAMP_DCDC);
     COG_stopDCDC(); // Power off
+    d_applyPowerPolicy();
+    d_stamp(STAMP_END);
+
+    // Energy, each phase up to next reached stamp
+    uint8_t itemUpdate = (s_updateMode == UPDATE_NORMAL) ? ENERGY_UPDATE_NORMAL : ENERGY_UPDATE_FAST;
+    for (uint8_t stamp = STAMP_RESET; stamp < STAMP_END; stamp += 1)
+    {
+        if (d_stamps[stamp] == 0)
+        {
+            continue;
+        }
+
+        uint8_t next = stamp + 1;
+        while (d_stamps[next] == 0)
+        {
+            next += 1; // STAMP_END always reached
+        }
+        d_addEnergy(itemUpdate, CURRENT_RESET + stamp - STAMP_RESET, d_stamps[next] - d_stamps[stamp]);
+    }
+    d_energyCounts[itemUpdate] += 1;
+
+    // Touch-to-glass latency
+    uint32_t origin = (d_stamps[STAMP_INTERRUPT] > 0) ? d_stamps[STAMP_INTERRUPT] : d_stamps[STAMP_TOUCH];
+    if (origin > 0)
+    {
+        uint32_t latency = d_stamps[STAMP_DCDC] - origin;
+        uint8_t bucket;
+
+        // Buckets 0..7 = 0..7 ms, then 8 buckets per power of 2
+        if (latency < 8)
+        {
+            bucket = latency;
+        }
+        else
+        {
+            uint8_t exponent = 3;
+            while ((latency >> (exponent + 1)) > 0)
+            {
+                exponent += 1;
+            }
+            uint16_t index = 8 + (exponent - 3) * 8 + ((latency >> (exponent - 3)) & 0x07);
+            bucket = (index < 128) ? index : 127;
+        }
+
+        if (d_latencyBuckets[bucket] < UINT16_MAX)
+        {
+            d_latencyBuckets[bucket] += 1;
+        }
+        d_latencyCount += 1;
+    }
+}
+
+void Pervasive_Touch_Small::updateNormal(FRAMEBUFFER_CONST_TYPE frame, uint32_t sizeFrame)
+{
+    if (sizeFrame != (uint32_t)s_sizeX * s_sizeY / 8)
+    {
+        hV_HAL_log(LEVEL_ERROR, "Frame size %i, expected %i", sizeFrame, s_sizeX * s_sizeY / 8);
+        return;
+    }
+
+    d_beginUpdate(UPDATE_NORMAL);
+    COG_sendImageDataNormal(frame, sizeFrame);
+    d_endUpdate();
+
+    s_fingerprint = d_getFingerprint(frame, sizeFrame);
 }
 
 void Pervasive_Touch_Small::updateFast(FRAMEBUFFER_CONST_TYPE frame1,
                                        FRAMEBUFFER_CONST_TYPE frame2, uint32_t sizeFrame)
 {
-    b_resume(); // GPIO
-    COG_reset(); // Reset
-
-    if (u_flagOTP == false)
+    if (sizeFrame != (uint32_t)s_sizeX * s_sizeY / 8)
     {
-        COG_getDataOTP(); // 3-wire SPI read OTP memory
-        COG_reset(); // Reset
+        hV_HAL_log(LEVEL_ERROR, "Frame size %i, expected %i", sizeFrame, s_sizeX * s_sizeY / 8);
+        return;
     }
 
-    // Start SPI
-    hV_HAL_SPI_begin(16000000); // Fast 16 MHz, with unicity check
-
-    COG_initial(UPDATE_FAST); // Initialise
+    d_beginUpdate(UPDATE_FAST);
     COG_sendImageDataFast(frame1, frame2, sizeFrame);
+    d_endUpdate();
 
-    COG_update(); // Update
-    COG_stopDCDC(); // Power off
+    s_fingerprint = d_getFingerprint(frame1, sizeFrame);
 }
 
 //
-// === Touch section
+// === Packing section
 //
-void Pervasive_Touch_Small::d_beginTouch()
+void Pervasive_Touch_Small::setPacking(uint8_t mode, uint8_t threshold)
 {
-    // v_touchTrim = 0x10; // standard threshold
-    // v_touchEvent = true;
+    s_packingMode = mode;
+    s_packingThreshold = threshold;
+}
 
-    // Target   FSM_ON
-    // Source   FSM_OFF -> FSM_SLEEP
-    //          FSM_SLEEP
-    if (d_fsmPowerTouch == FSM_OFF)
+void Pervasive_Touch_Small::updateNormalGrey(FRAMEBUFFER_CONST_TYPE grey, uint32_t sizeGrey)
+{
+    if (sizeGrey != (uint32_t)s_sizeX * s_sizeY)
     {
-        hV_HAL_Wire_begin();
+        hV_HAL_log(LEVEL_ERROR, "Grey frame size %i, expected %i", sizeGrey, s_sizeX * s_sizeY);
+        return;
+    }
 
-#if (DEBUG_POWER > 0)
+    d_beginUpdate(UPDATE_NORMAL);
 
-        hV_HAL_log(LEVEL_DEBUG, "%24s %4s I2C.GPIO %02x -> %02x", "d_beginTouch", "I2C", d_fsmPowerTouch, (d_fsmPowerTouch | FSM_SLEEP));
+    // Application note § 5. Input image to the EPD
+    COG_sendIndexGrey(0x10, grey); // First frame, blackBuffer
+    b_sendIndexFixed(0x13, 0x00, sizeGrey / 8); // Second frame, 0x00
 
-#endif // DEBUG_POWER
+    d_endUpdate();
+    s_fingerprint = 0; // Packed frame not kept
+}
 
-        d_fsmPowerTouch |= FSM_BUS_MASK;
+void Pervasive_Touch_Small::updateFastGrey(FRAMEBUFFER_CONST_TYPE grey1,
+                                           FRAMEBUFFER_CONST_TYPE grey2, uint32_t sizeGrey)
+{
+    if (sizeGrey != (uint32_t)s_sizeX * s_sizeY)
+    {
+        hV_HAL_log(LEVEL_ERROR, "Grey frame size %i, expected %i", sizeGrey, s_sizeX * s_sizeY);
+        return;
     }
 
-    // if (b_pin.touchInt != NOT_CONNECTED) already tested
-    hV_HAL_GPIO_define(b_pin.touchInt, INPUT_PULLUP);
-
-    // if (b_pin.touchReset != NOT_CONNECTED) already tested
-    hV_HAL_GPIO_define(b_pin.touchReset, OUTPUT);
-    d_fsmPowerTouch |= FSM_GPIO_MASK;
+    d_beginUpdate(UPDATE_FAST);
 
-    if (SCREEN_SIZE(u_eScreen_EPD) == SIZE_271)
+    // Application note § 5. Input image to the EPD
+    if (s_flag50)
     {
-        hV_HAL_GPIO_set(b_pin.touchReset);
-        hV_HAL_delayMilliseconds(100);
-        hV_HAL_GPIO_clear(b_pin.touchReset);
-        hV_HAL_delayMilliseconds(100);
-        hV_HAL_GPIO_set(b_pin.touchReset);
-        hV_HAL_delayMilliseconds(100);
-
-        d_touchAddress = TOUCH_271_ADDRESS; // 0x41
-
-        // // v_touchXmax and v_touchYmax read from controller
-        // uint8_t bufferWrite[1] = {0};
-        // uint8_t bufferRead[10] = {0};
-        //
-        // bufferWrite[0] = 0x20;
-        // hV_HAL_Wire_transfer(d_touchAddress, bufferWrite, 1, bufferRead, 10);
-        // v_touchXmin = 0;
-        // v_touchXmax = bufferRead[0] + (bufferRead[1] << 8); // Xmax
-        // v_touchYmin = 0;
-        // v_touchYmax = bufferRead[2] + (bufferRead[3] << 8); // Ymax
-
-        // // v_touchXmax and v_touchYmax hard-coded
-        // v_touchXmin = 0;
-        // v_touchXmax = 176; // Xmax
-        // v_touchYmin = 0;
-        // v_touchYmax = 264; // Ymax
+        b_sendCommandData8(0x50, 0x27); // Vcom and data interval setting
     }
-    // else if (SCREEN_SIZE(u_eScreen_EPD) == SIZE_343)
-    // {
-    //     hV_HAL_GPIO_set(b_pin.touchReset);
-    //     hV_HAL_delayMilliseconds(10);
-    //     hV_HAL_GPIO_clear(b_pin.touchReset);
-    //     hV_HAL_delayMilliseconds(10);
-    //     hV_HAL_GPIO_set(b_pin.touchReset);
-    //     hV_HAL_delayMilliseconds(1000);
-    //
-    //     d_touchAddress = TOUCH_343_ADDRESS; // 0x4A
-    //
-    //     // uint8_t bufferWrite[1] = {0};
-    //     // uint8_t bufferRead[4] = {0};
-    //     //
-    //     // bufferWrite[0] = 0xa6;
-    //     // hV_HAL_Wire_transfer(_touchAddress, bufferWrite, 1, bufferRead, 4);
-    //
-    //     // // v_touchXmax and v_touchYmax hard-coded
-    //     // v_touchXmin = 0;
-    //     // v_touchXmax = 455; // Xmax, hardware hard-coded
-    //     // v_touchYmin = 0;
-    //     // v_touchYmax = 391; // Ymax, hardware hard-coded
-    // }
-    else if (SCREEN_SIZE(u_eScreen_EPD) == SIZE_370)
-    {
-        hV_HAL_GPIO_set(b_pin.touchReset);
-        hV_HAL_delayMilliseconds(10);
-        hV_HAL_GPIO_clear(b_pin.touchReset);
-        hV_HAL_delayMilliseconds(10);
-        hV_HAL_GPIO_set(b_pin.touchReset);
-        hV_HAL_delayMilliseconds(1000);
-
-        d_touchAddress = TOUCH_370_ADDRESS; // 0x38
 
-        // uint8_t bufferWrite[1] = {0};
-        // uint8_t bufferRead[4] = {0};
-        //
-        // bufferWrite[0] = 0xa6;
-        // hV_HAL_Wire_transfer(d_touchAddress, bufferWrite, 1, bufferRead, 4);
+    COG_sendIndexGrey(0x10, grey2); // First frame, previous image
+    COG_sendIndexGrey(0x13, grey1); // Second frame, next image
 
-        // // v_touchXmax and v_touchYmax hard-coded
-        // v_touchXmin = 0;
-        // v_touchXmax = 239; // Xmax, hardware hard-coded
-        // v_touchYmin = 0;
-        // v_touchYmax = 415; // Ymax, hardware hard-coded
+    if (s_flag50)
+    {
+        b_sendCommandData8(0x50, 0x07); // Vcom and data interval setting
     }
-    d_touchPrevious = TOUCH_EVENT_NONE;
 
-    // Target   FSM_ON
-    // Source   FSM_SLEEP -> FSM_ON
-
-#if (DEBUG_POWER > 0)
-
-    hV_HAL_log(LEVEL_DEBUG, "%24s %4s I2C.GPIO %02x -> %02x", "d_beginTouch", "GPIO", d_fsmPowerTouch, FSM_ON);
-
-#endif // DEBUG_POWER
+    d_endUpdate();
+    s_fingerprint = 0; // Packed frame not kept
+}
 
-    d_fsmPowerTouch = FSM_ON;
+/// @cond NOT_PUBLIC
+void Pervasive_Touch_Small::COG_selectIndex(uint8_t index)
+{
+    // Same framing as b_sendIndexData(), data sent by caller
+    hV_HAL_GPIO_clear(b_pin.panelDC); // DC Low = Command
+    hV_HAL_GPIO_clear(b_pin.panelCS); // CS Low = Select
+    hV_HAL_delayMicroseconds(b_delayCS);
+    hV_HAL_SPI_transfer(index);
+    hV_HAL_delayMicroseconds(b_delayCS);
+    hV_HAL_GPIO_set(b_pin.panelDC); // DC High = Data
 }
 
-void Pervasive_Touch_Small::d_getRawTouch(touch_t & touch)
+void Pervasive_Touch_Small::COG_unselect()
 {
-    bool flagValid = false;
-    uint8_t flagInterrupt = 1 - hV_HAL_GPIO_get(b_pin.touchInt);
-    hV_HAL_delayMilliseconds(10);
+    hV_HAL_delayMicroseconds(b_delayCS);
+    hV_HAL_GPIO_set(b_pin.panelCS); // CS High = Unselect
+}
 
-    if (SCREEN_SIZE(u_eScreen_EPD) == SIZE_271)
+void Pervasive_Touch_Small::COG_packRow(FRAMEBUFFER_CONST_TYPE greyRow, uint16_t row, uint8_t * packedRow, int16_t * errorRow)
+{
+    // Bit 7 = left-most pixel, bit set = black
+    switch (s_packingMode)
     {
-        uint8_t bufferWrite[1] = {0};
-        uint8_t bufferRead[5] = {0};
-
-        bufferWrite[0] = 0x10; // check
-        hV_HAL_Wire_transfer(d_touchAddress, bufferWrite, 1, bufferRead, 1);
-
-        uint8_t number = bufferRead[0];
-        touch.z = 0;
-        touch.t = TOUCH_EVENT_NONE;
-
-        // Only one finger read, flagInterrupt not used
-        // if ((number > 0) and (number < 3) and (flagInterrupt > 0))
-        if ((number > 0) and (number < 3))
+        case PACKING_ORDERED:
         {
-            bufferWrite[0] = 0x11; // report
-            hV_HAL_Wire_transfer(d_touchAddress, bufferWrite, 1, bufferRead, 5);
-
-            uint8_t status = bufferRead[0];
-            touch.x = (bufferRead[1] << 8) + bufferRead[2];
-            touch.y = (bufferRead[3] << 8) + bufferRead[4];
-
-            if (status & 0x80) // touch
+            // Bayer matrix, thresholds = 16 * rank + 8
+            static const uint8_t bayer[4][4] =
             {
-                touch.t = (d_touchPrevious != TOUCH_EVENT_NONE) ? TOUCH_EVENT_MOVE : TOUCH_EVENT_PRESS;
-
-                // Keep position for next release
-                d_touchPrevious = TOUCH_EVENT_PRESS;
-                d_touchX = touch.x;
-                d_touchY = touch.y;
-            }
-            else
+                { 0x08, 0x88, 0x28, 0xa8 },
+                { 0xc8, 0x48, 0xe8, 0x68 },
+                { 0x38, 0xb8, 0x18, 0x98 },
+                { 0xf8, 0x78, 0xd8, 0x58 }
+            };
+            const uint8_t * line = bayer[row & 0x03];
+
+            for (uint16_t index = 0; index < s_sizeX; index += 8)
             {
-                touch.t = TOUCH_EVENT_RELEASE;
+                const uint8_t * pixel = greyRow + index;
+                packedRow[index >> 3] = ((pixel[0] < line[0]) << 7) | ((pixel[1] < line[1]) << 6)
+                                        | ((pixel[2] < line[2]) << 5) | ((pixel[3] < line[3]) << 4)
+                                        | ((pixel[4] < line[0]) << 3) | ((pixel[5] < line[1]) << 2)
+                                        | ((pixel[6] < line[2]) << 1) | (pixel[7] < line[3]);
             }
-            touch.z = 0x16;
         }
-        else // no touch
+        break;
+
+        case PACKING_DIFFUSION:
         {
-            if (d_touchPrevious == TOUCH_EVENT_NONE)
+            // Single error row, errorRow[x + 1] for pixel x
+            // Right 7/16 in carry, next row 3/16 5/16 1/16 written behind the cursor
+            int16_t carry = 0;
+            int16_t errorLeft = 0; // Next row, pixel x - 1
+            int16_t errorHere = 0; // Next row, pixel x
+
+            for (uint16_t index = 0; index < s_sizeX; index += 8)
             {
-                touch.t = TOUCH_EVENT_NONE;
-                touch.z = 0;
+                uint8_t value = 0;
+
+                for (uint8_t bit = 0; bit < 8; bit += 1)
+                {
+                    uint16_t x = index + bit;
+                    int16_t level = greyRow[x] + errorRow[x + 1] + carry;
+                    int16_t error;
+
+                    if (level < 0x80)
+                    {
+                        value |= (0x80 >> bit);
+                        error = level;
+                    }
+                    else
+                    {
+                        error = level - 0xff;
+                    }
+
+                    carry = (error * 7) / 16;
+                    errorRow[x] = errorLeft + (error * 3) / 16;
+                    errorLeft = errorHere + (error * 5) / 16;
+                    errorHere = error / 16;
+                }
+                packedRow[index >> 3] = value;
             }
-            else // Take previous position for release
+            errorRow[s_sizeX] = errorLeft;
+        }
+        break;
+
+        default: // PACKING_THRESHOLD
+        {
+            const uint8_t threshold = s_packingThreshold;
+
+            for (uint16_t index = 0; index < s_sizeX; index += 8)
             {
-                d_touchPrevious = TOUCH_EVENT_NONE;
-                touch.t = TOUCH_EVENT_RELEASE;
-                touch.x = d_touchX;
-                touch.y = d_touchY;
-                touch.z = 0x16;
+                const uint8_t * pixel = greyRow + index;
+                packedRow[index >> 3] = ((pixel[0] < threshold) << 7) | ((pixel[1] < threshold) << 6)
+                                        | ((pixel[2] < threshold) << 5) | ((pixel[3] < threshold) << 4)
+                                        | ((pixel[4] < threshold) << 3) | ((pixel[5] < threshold) << 2)
+                                        | ((pixel[6] < threshold) << 1) | (pixel[7] < threshold);
             }
         }
+        break;
     }
-    // else if (SCREEN_SIZE(u_eScreen_EPD) == SIZE_343)
-    // {
+}
+
+void Pervasive_Touch_Small::COG_sendIndexGrey(uint8_t index, FRAMEBUFFER_CONST_TYPE grey)
+{
+    if (s_packingMode == PACKING_DIFFUSION)
+    {
+        // Error row on the stack, only for diffusion
+        int16_t errorRow[240 + 2] = {0}; // Largest native row, with margins
+        COG_sendRowsGrey(index, grey, errorRow);
+    }
+    else
+    {
+        COG_sendRowsGrey(index, grey, nullptr);
+    }
+}
+
+void Pervasive_Touch_Small::COG_sendRowsGrey(uint8_t index, FRAMEBUFFER_CONST_TYPE grey, int16_t * errorRow)
+{
+    uint8_t packedRow[240 / 8]; // Largest native row
+    uint16_t sizeRow = s_sizeX / 8;
+
+    COG_selectIndex(index);
+    for (uint16_t row = 0; row < s_sizeY; row += 1)
+    {
+        COG_packRow(grey + (uint32_t)row * s_sizeX, row, packedRow, errorRow);
+
+        for (uint16_t column = 0; column < sizeRow; column += 1)
+        {
+            hV_HAL_SPI_transfer(packedRow[column]);
+        }
+    }
+    COG_unselect();
+}
+/// @endcond
+//
+// === End of Packing section
+//
+
+//
+// === Orientation section
+//
+void Pervasive_Touch_Small::setFrameOrientation(uint8_t orientation)
+{
+    s_frameOrientation = orientation % 4;
+}
+
+uint8_t Pervasive_Touch_Small::getFrameOrientation()
+{
+    return s_frameOrientation;
+}
+
+/// @cond NOT_PUBLIC
+// 8x8 bit-matrix transpose, Hacker's Delight § 7-3
+// Input A[j] bit (7 - i) becomes output B[i] bit (7 - j)
+static void transpose8(const uint8_t * A, uint8_t * B)
+{
+    uint32_t x = ((uint32_t)A[0] << 24) | ((uint32_t)A[1] << 16) | ((uint32_t)A[2] << 8) | A[3];
+    uint32_t y = ((uint32_t)A[4] << 24) | ((uint32_t)A[5] << 16) | ((uint32_t)A[6] << 8) | A[7];
+    uint32_t t;
+
+    t = (x ^ (x >> 7)) & 0x00aa00aa;
+    x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00aa00aa;
+    y = y ^ t ^ (t << 7);
+
+    t = (x ^ (x >> 14)) & 0x0000cccc;
+    x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000cccc;
+    y = y ^ t ^ (t << 14);
+
+    t = (x & 0xf0f0f0f0) | ((y >> 4) & 0x0f0f0f0f);
+    y = ((x << 4) & 0xf0f0f0f0) | (y & 0x0f0f0f0f);
+    x = t;
+
+    B[0] = x >> 24;
+    B[1] = x >> 16;
+    B[2] = x >> 8;
+    B[3] = x;
+    B[4] = y >> 24;
+    B[5] = y >> 16;
+    B[6] = y >> 8;
+    B[7] = y;
+}
+
+static uint8_t reverse8(uint8_t value)
+{
+    value = (value >> 4) | (value << 4);
+    value = ((value & 0xcc) >> 2) | ((value & 0x33) << 2);
+    value = ((value & 0xaa) >> 1) | ((value & 0x55) << 1);
+    return value;
+}
+
+void Pervasive_Touch_Small::COG_sendIndexFrame(uint8_t index, FRAMEBUFFER_CONST_TYPE frame, uint32_t sizeFrame)
+{
+    if (s_frameOrientation == 0)
+    {
+        b_sendIndexData(index, frame, sizeFrame);
+        return;
+    }
+
+    uint16_t sizeRow = s_sizeX / 8; // Native row, bytes
+    uint16_t sizeColumn = s_sizeY / 8; // Native column, bytes
+
+    // Frame size checked by updateNormal() and updateFast()
+    COG_selectIndex(index);
+
+    if (s_frameOrientation == 2)
+    {
+        // Native (x, y) = frame (sizeX - 1 - x, sizeY - 1 - y)
+        for (uint32_t position = sizeFrame; position > 0; position -= 1)
+        {
+            hV_HAL_SPI_transfer(reverse8(frame[position - 1]));
+        }
+    }
+    else
+    {
+        // Frame is sizeY wide and sizeX high, sizeColumn bytes per line
+        // 1 = 90°: native (x, y) = frame (y, sizeX - 1 - x)
+        // 3 = 270°: native (x, y) = frame (sizeY - 1 - y, x)
+        uint8_t band[8][240 / 8]; // 8 native rows, largest native row
+        uint8_t source[8];
+        uint8_t target[8];
+
+        for (uint16_t bandY = 0; bandY < sizeColumn; bandY += 1)
+        {
+            for (uint16_t bandX = 0; bandX < sizeRow; bandX += 1)
+            {
+                for (uint8_t j = 0; j < 8; j += 1)
+                {
+                    if (s_frameOrientation == 1)
+                    {
+                        source[j] = frame[(uint32_t)(s_sizeX - 1 - bandX * 8 - j) * sizeColumn + bandY];
+                    }
+                    else
+                    {
+                        source[j] = frame[(uint32_t)(bandX * 8 + j) * sizeColumn + sizeColumn - 1 - bandY];
+                    }
+                }
+
+                transpose8(source, target);
+
+                for (uint8_t i = 0; i < 8; i += 1)
+                {
+                    band[i][bandX] = (s_frameOrientation == 1) ? target[i] : target[7 - i];
+                }
+            }
+
+            for (uint8_t i = 0; i < 8; i += 1)
+            {
+                for (uint16_t bandX = 0; bandX < sizeRow; bandX += 1)
+                {
+                    hV_HAL_SPI_transfer(band[i][bandX]);
+                }
+            }
+        }
+    }
+
+    COG_unselect();
+}
+/// @endcond
+//
+// === End of Orientation section
+//
+
+//
+// === Frame assets section
+//
+// Store, little-endian, generated by extras/frame_assets.py
+// Header  0..3 "PDFA", 4 version, 5 reserved, 6..7 number of entries
+// Entry   0..1 screen size, 2..3 identifier, 4..7 offset, 8..11 size
+// Frames  packed 1-bpp, native orientation, bit 7 = left-most pixel, bit set = black
+#define ASSET_VERSION 1
+#define ASSET_SIZE_HEADER 8
+#define ASSET_SIZE_ENTRY 12
+
+uint8_t Pervasive_Touch_Small::updateNormalAsset(FRAMEBUFFER_CONST_TYPE store, uint32_t sizeStore,
+        uint16_t identifier)
+{
+    FRAMEBUFFER_CONST_TYPE frame;
+    uint32_t sizeFrame;
+
+    if (d_findFrameAsset(store, sizeStore, identifier, frame, sizeFrame) == RESULT_ERROR)
+    {
+        return RESULT_ERROR;
+    }
+
+    // Assets are in native orientation
+    uint8_t saveOrientation = s_frameOrientation;
+    s_frameOrientation = 0;
+    updateNormal(frame, sizeFrame);
+    s_frameOrientation = saveOrientation;
+
+    return RESULT_SUCCESS;
+}
+
+uint8_t Pervasive_Touch_Small::updateFastAsset(FRAMEBUFFER_CONST_TYPE store, uint32_t sizeStore,
+        uint16_t identifier1, uint16_t identifier2)
+{
+    FRAMEBUFFER_CONST_TYPE frame1;
+    FRAMEBUFFER_CONST_TYPE frame2;
+    uint32_t sizeFrame;
+
+    if ((d_findFrameAsset(store, sizeStore, identifier1, frame1, sizeFrame) == RESULT_ERROR)
+            or (d_findFrameAsset(store, sizeStore, identifier2, frame2, sizeFrame) == RESULT_ERROR))
+    {
+        return RESULT_ERROR;
+    }
+
+    // Assets are in native orientation
+    uint8_t saveOrientation = s_frameOrientation;
+    s_frameOrientation = 0;
+    updateFast(frame1, frame2, sizeFrame);
+    s_frameOrientation = saveOrientation;
+
+    return RESULT_SUCCESS;
+}
+
+uint8_t Pervasive_Touch_Small::d_findFrameAsset(FRAMEBUFFER_CONST_TYPE store, uint32_t sizeStore, uint16_t identifier,
+        FRAMEBUFFER_CONST_TYPE & frame, uint32_t & sizeFrame)
+{
+    // Byte-wise reads, no alignment required
+    if ((sizeStore < ASSET_SIZE_HEADER) or (store[0] != 'P') or (store[1] != 'D') or (store[2] != 'F') or (store[3] != 'A'))
+    {
+        hV_HAL_log(LEVEL_ERROR, "Frame assets store not recognised");
+        return RESULT_ERROR;
+    }
+
+    if (store[4] != ASSET_VERSION)
+    {
+        hV_HAL_log(LEVEL_ERROR, "Frame assets store version %i, expected %i", store[4], ASSET_VERSION);
+        return RESULT_ERROR;
+    }
+
+    uint16_t number = store[6] | (store[7] << 8);
+    if (sizeStore < ASSET_SIZE_HEADER + (uint32_t)number * ASSET_SIZE_ENTRY)
+    {
+        hV_HAL_log(LEVEL_ERROR, "Frame assets store truncated");
+        return RESULT_ERROR;
+    }
+
+    uint16_t screenSize = SCREEN_SIZE(u_eScreen_EPD);
+    uint32_t sizeExpected = (uint32_t)s_sizeX * s_sizeY / 8;
+
+    for (uint16_t index = 0; index < number; index += 1)
+    {
+        FRAMEBUFFER_CONST_TYPE entry = store + ASSET_SIZE_HEADER + (uint32_t)index * ASSET_SIZE_ENTRY;
+
+        if (((entry[0] | (entry[1] << 8)) != screenSize) or ((entry[2] | (entry[3] << 8)) != identifier))
+        {
+            continue;
+        }
+
+        uint32_t offset = entry[4] | ((uint32_t)entry[5] << 8) | ((uint32_t)entry[6] << 16) | ((uint32_t)entry[7] << 24);
+        uint32_t size = entry[8] | ((uint32_t)entry[9] << 8) | ((uint32_t)entry[10] << 16) | ((uint32_t)entry[11] << 24);
+
+        if (size != sizeExpected)
+        {
+            hV_HAL_log(LEVEL_ERROR, "Frame asset %i size %i, expected %i", identifier, size, sizeExpected);
+            return RESULT_ERROR;
+        }
+
+        if ((offset > sizeStore) or (size > sizeStore - offset))
+        {
+            hV_HAL_log(LEVEL_ERROR, "Frame asset %i out of store", identifier);
+            return RESULT_ERROR;
+        }
+
+        frame = store + offset;
+        sizeFrame = size;
+        return RESULT_SUCCESS;
+    }
+
+    hV_HAL_log(LEVEL_ERROR, "Frame asset %i not found for screen size %i", identifier, screenSize);
+    return RESULT_ERROR;
+}
+//
+// === End of Frame assets section
+//
+
+//
+// === Latency section
+//
+uint32_t Pervasive_Touch_Small::getStamp(uint8_t stamp)
+{
+    return (stamp < STAMP_NUMBER) ? d_stamps[stamp] : 0;
+}
+
+uint32_t Pervasive_Touch_Small::getLatencyPercentile(uint8_t percentile)
+{
+    uint32_t total = 0;
+    for (uint8_t bucket = 0; bucket < 128; bucket += 1)
+    {
+        total += d_latencyBuckets[bucket];
+    }
+
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    // Rank rounded up, at least first measure
+    uint32_t rank = (total * ((percentile < 100) ? percentile : 100) + 99) / 100;
+    rank = (rank > 0) ? rank : 1;
+
+    uint32_t cumul = 0;
+    uint8_t bucket = 0;
+    for (bucket = 0; bucket < 127; bucket += 1)
+    {
+        cumul += d_latencyBuckets[bucket];
+        if (cumul >= rank)
+        {
+            break;
+        }
+    }
+
+    // Upper bound of the bucket
+    if (bucket < 8)
+    {
+        return bucket;
+    }
+    uint8_t exponent = (bucket - 8) / 8 + 3;
+    uint8_t fraction = (bucket - 8) % 8;
+    return ((uint32_t)(9 + fraction) << (exponent - 3)) - 1;
+}
+
+uint32_t Pervasive_Touch_Small::getLatencyCount()
+{
+    return d_latencyCount;
+}
+
+uint32_t Pervasive_Touch_Small::getInitialDuration()
+{
+    return d_initialDuration;
+}
+
+void Pervasive_Touch_Small::stampInterrupt()
+{
+    d_stampTouchEvent(true, TOUCH_EVENT_NONE);
+}
+
+void Pervasive_Touch_Small::resetLatency()
+{
+    for (uint8_t bucket = 0; bucket < 128; bucket += 1)
+    {
+        d_latencyBuckets[bucket] = 0;
+    }
+    d_latencyCount = 0;
+}
+
+/// @cond NOT_PUBLIC
+void Pervasive_Touch_Small::d_stamp(uint8_t stamp)
+{
+    // 0 is reserved for not reached
+    uint32_t chrono = hV_HAL_getMilliseconds();
+    d_stamps[stamp] = (chrono > 0) ? chrono : 1;
+}
+
+void Pervasive_Touch_Small::d_stampTouchEvent(bool flagInterrupt, uint8_t event)
+{
+    // First interrupt edge of the contact served by next update
+    // Edge older than last release = contact ended without update, replaced
+    uint32_t chrono = hV_HAL_getMilliseconds();
+    chrono = (chrono > 0) ? chrono : 1;
+
+    if (flagInterrupt and ((d_stampInterrupt == 0) or (d_stampInterrupt < d_stampRelease)))
+    {
+        d_stampInterrupt = chrono;
+    }
+    if (event == TOUCH_EVENT_PRESS)
+    {
+        d_stampTouch = chrono;
+    }
+    else if (event == TOUCH_EVENT_RELEASE)
+    {
+        d_stampRelease = chrono;
+    }
+}
+/// @endcond
+//
+// === End of Latency section
+//
+
+//
+// === Trace section
+//
+#define TRACE_RECORD 0x01
+#define TRACE_REPLAY 0x02
+#define TRACE_SIZE_HEADER 4
+#define TRACE_SIZE_RECORD 6 // Without payload
+
+void Pervasive_Touch_Small::beginTouchRecord(uint8_t * buffer, uint32_t sizeBuffer, uint8_t scope)
+{
+    d_traceMode = 0;
+    if (sizeBuffer < TRACE_SIZE_HEADER)
+    {
+        hV_HAL_log(LEVEL_ERROR, "Trace buffer too small");
+        return;
+    }
+
+    buffer[0] = 'P';
+    buffer[1] = 'T';
+    buffer[2] = 'T';
+    buffer[3] = 1; // Version
+
+    d_traceRecord = buffer;
+    d_traceSize = sizeBuffer;
+    d_traceLength = TRACE_SIZE_HEADER;
+    d_traceFull = false;
+    d_traceScope = scope;
+    d_traceLevel = 0xff; // First INT read recorded
+    d_traceStart = hV_HAL_getMilliseconds();
+    d_traceChrono = 0;
+    d_traceMode = TRACE_RECORD;
+}
+
+uint32_t Pervasive_Touch_Small::endTouchRecord()
+{
+    if (d_traceMode != TRACE_RECORD)
+    {
+        return 0;
+    }
+
+    d_traceMode = 0;
+    return d_traceLength;
+}
+
+void Pervasive_Touch_Small::beginTouchReplay(FRAMEBUFFER_CONST_TYPE buffer, uint32_t sizeBuffer, uint8_t speed)
+{
+    d_traceMode = 0;
+    if ((sizeBuffer < TRACE_SIZE_HEADER) or (buffer[0] != 'P') or (buffer[1] != 'T') or (buffer[2] != 'T') or (buffer[3] != 1))
+    {
+        hV_HAL_log(LEVEL_ERROR, "Touch trace not recognised");
+        return;
+    }
+
+    // Types present in the trace and presses, truncated last record ignored
+    d_traceScope = 0;
+    d_tracePresses = 0;
+    uint32_t position = TRACE_SIZE_HEADER;
+    while ((position + TRACE_SIZE_RECORD <= sizeBuffer) and (position + TRACE_SIZE_RECORD + buffer[position + 5] <= sizeBuffer))
+    {
+        d_traceScope |= buffer[position];
+        if ((buffer[position] == TRACE_TOUCH) and (buffer[position + 5] >= 7) and (buffer[position + TRACE_SIZE_RECORD + 6] == TOUCH_EVENT_PRESS))
+        {
+            d_tracePresses += 1;
+        }
+        position += TRACE_SIZE_RECORD + buffer[position + 5];
+    }
+    if (position < sizeBuffer)
+    {
+        hV_HAL_log(LEVEL_WARNING, "Touch trace truncated at %i bytes", position);
+    }
+
+    d_traceReplay = buffer;
+    d_traceSize = position;
+    for (uint8_t slot = 0; slot < 3; slot += 1)
+    {
+        d_traceCursor[slot] = 0;
+        d_traceGroup[slot] = 0;
+        d_traceNext[slot] = d_traceFind(1 << slot, TRACE_SIZE_HEADER);
+    }
+    d_tracePosition = TRACE_SIZE_HEADER;
+    d_traceNow = 0;
+    d_traceChrono = 0;
+    d_traceSpeed = speed;
+    d_traceMismatches = 0;
+    d_tracePressesReplayed = 0;
+    d_traceStart = hV_HAL_getMilliseconds();
+    d_touchPrevious = TOUCH_EVENT_NONE;
+    d_traceMode = TRACE_REPLAY;
+}
+
+uint32_t Pervasive_Touch_Small::endTouchReplay()
+{
+    if (d_traceMode != TRACE_REPLAY)
+    {
+        return 0;
+    }
+
+    d_traceMode = 0;
+    d_touchPrevious = TOUCH_EVENT_NONE;
+
+    // Presses recorded but not replayed, e.g. contacts shorter than the polling period
+    uint32_t missed = (d_tracePresses > d_tracePressesReplayed) ? d_tracePresses - d_tracePressesReplayed : 0;
+    if (missed > 0)
+    {
+        hV_HAL_log(LEVEL_WARNING, "Touch replay missed %i of %i presses", missed, d_tracePresses);
+    }
+    return d_traceMismatches + missed;
+}
+
+/// @cond NOT_PUBLIC
+uint8_t Pervasive_Touch_Small::d_readInterrupt()
+{
+    uint8_t level = HIGH; // Idle
+
+    if (d_traceMode == TRACE_REPLAY)
+    {
+        // Level from the latest transition due
+        d_traceRead(TRACE_INTERRUPT, &level, 1);
+    }
+    else
+    {
+        level = hV_HAL_GPIO_get(b_pin.touchInt);
+
+        // Transitions only
+        if ((d_traceMode == TRACE_RECORD) and (level != d_traceLevel))
+        {
+            d_traceLevel = level;
+            d_traceWrite(TRACE_INTERRUPT, &level, 1);
+        }
+    }
+    return level;
+}
+
+void Pervasive_Touch_Small::d_readTouch(uint8_t command, uint8_t * bufferRead, uint8_t sizeRead)
+{
+    uint8_t payload[2 + 16];
+
+    if (d_traceMode == TRACE_REPLAY)
+    {
+        // No record yet = no data
+        for (uint8_t index = 0; index < sizeRead; index += 1)
+        {
+            bufferRead[index] = 0x00;
+        }
+
+        if (d_traceRead(TRACE_WIRE, payload, 2 + sizeRead, command))
+        {
+            // Record for another device, no data
+            if (payload[0] != d_touchAddress)
+            {
+                d_traceMismatches += 1;
+                return;
+            }
+
+            for (uint8_t index = 0; index < sizeRead; index += 1)
+            {
+                bufferRead[index] = payload[2 + index];
+            }
+        }
+        else if (d_traceCursor[TRACE_WIRE >> 1] > 0)
+        {
+            // Latest recorded poll without this register
+            d_traceMismatches += 1;
+        }
+    }
+    else
+    {
+        hV_HAL_Wire_transfer(d_touchAddress, &command, 1, bufferRead, sizeRead);
+        d_touchTransactions += 1;
+
+        if ((d_traceMode == TRACE_RECORD) and (sizeRead <= 16))
+        {
+            payload[0] = d_touchAddress;
+            payload[1] = command;
+            for (uint8_t index = 0; index < sizeRead; index += 1)
+            {
+                payload[2 + index] = bufferRead[index];
+            }
+            d_traceWrite(TRACE_WIRE, payload, 2 + sizeRead);
+        }
+    }
+}
+
+void Pervasive_Touch_Small::d_traceWrite(uint8_t type, const uint8_t * payload, uint8_t length)
+{
+    if ((d_traceScope & type) == 0)
+    {
+        return;
+    }
+
+    // Buffer full, recording stops, trace kept for endTouchRecord()
+    if (d_traceFull)
+    {
+        return;
+    }
+    if (d_traceLength + TRACE_SIZE_RECORD + length > d_traceSize)
+    {
+        d_traceFull = true;
+        hV_HAL_log(LEVEL_WARNING, "Touch trace full at %i bytes", d_traceLength);
+        return;
+    }
+
+    uint32_t chrono = d_traceChrono;
+    uint8_t * record = d_traceRecord + d_traceLength;
+
+    record[0] = type;
+    record[1] = chrono;
+    record[2] = chrono >> 8;
+    record[3] = chrono >> 16;
+    record[4] = chrono >> 24;
+    record[5] = length;
+    for (uint8_t index = 0; index < length; index += 1)
+    {
+        record[TRACE_SIZE_RECORD + index] = payload[index];
+    }
+    d_traceLength += TRACE_SIZE_RECORD + length;
+}
+
+void Pervasive_Touch_Small::d_traceTick(bool flagAdvance)
+{
+    if (d_traceMode == TRACE_RECORD)
+    {
+        d_traceChrono = hV_HAL_getMilliseconds() - d_traceStart;
+    }
+    else if (d_traceMode == TRACE_REPLAY)
+    {
+        if (d_traceSpeed > 0)
+        {
+            d_traceChrono = (hV_HAL_getMilliseconds() - d_traceStart) * d_traceSpeed;
+        }
+        else if (d_tracePosition < d_traceSize)
+        {
+            // As fast as polled, next recorded poll, taken only if flagAdvance
+            d_traceChrono = d_traceStamp(d_tracePosition);
+            if (flagAdvance)
+            {
+                d_traceNow = d_traceChrono;
+                while ((d_tracePosition < d_traceSize) and (d_traceStamp(d_tracePosition) <= d_traceNow))
+                {
+                    d_tracePosition += TRACE_SIZE_RECORD + d_traceReplay[d_tracePosition + 5];
+                }
+            }
+        }
+        else
+        {
+            d_traceChrono = d_traceNow; // End of trace
+        }
+    }
+}
+
+bool Pervasive_Touch_Small::d_traceRead(uint8_t type, uint8_t * payload, uint8_t length, uint8_t command)
+{
+    // One slot per type, TRACE_TOUCH = 0, TRACE_INTERRUPT = 1, TRACE_WIRE = 2
+    uint8_t slot = type >> 1;
+
+    // Latest record due, older ones superseded
+    while ((d_traceNext[slot] < d_traceSize) and (d_traceStamp(d_traceNext[slot]) <= d_traceChrono))
+    {
+        if ((d_traceCursor[slot] == 0) or (d_traceStamp(d_traceNext[slot]) != d_traceStamp(d_traceCursor[slot])))
+        {
+            d_traceGroup[slot] = d_traceNext[slot];
+        }
+        d_traceCursor[slot] = d_traceNext[slot];
+        d_traceNext[slot] = d_traceFind(type, d_traceCursor[slot] + TRACE_SIZE_RECORD + d_traceReplay[d_traceCursor[slot] + 5]);
+    }
+
+    if (d_traceCursor[slot] == 0)
+    {
+        return false; // Nothing due yet
+    }
+
+    // I2C reply for the register among the records of the latest poll
+    uint32_t position = d_traceCursor[slot];
+    if (type == TRACE_WIRE)
+    {
+        position = d_traceGroup[slot];
+        while ((position <= d_traceCursor[slot]) and (d_traceReplay[position + TRACE_SIZE_RECORD + 1] != command))
+        {
+            position = d_traceFind(type, position + TRACE_SIZE_RECORD + d_traceReplay[position + 5]);
+        }
+        if (position > d_traceCursor[slot])
+        {
+            return false;
+        }
+    }
+
+    FRAMEBUFFER_CONST_TYPE record = d_traceReplay + position;
+    for (uint8_t index = 0; index < length; index += 1)
+    {
+        payload[index] = (index < record[5]) ? record[TRACE_SIZE_RECORD + index] : 0x00;
+    }
+    return true;
+}
+
+bool Pervasive_Touch_Small::d_traceReadEvent(uint8_t * payload)
+{
+    uint8_t slot = TRACE_TOUCH >> 1;
+
+    // Each result once, moves followed by another due result skipped
+    while ((d_traceNext[slot] < d_traceSize) and (d_traceStamp(d_traceNext[slot]) <= d_traceChrono))
+    {
+        FRAMEBUFFER_CONST_TYPE record = d_traceReplay + d_traceNext[slot];
+        d_traceNext[slot] = d_traceFind(TRACE_TOUCH, d_traceNext[slot] + TRACE_SIZE_RECORD + record[5]);
+
+        if ((record[TRACE_SIZE_RECORD + 6] == TOUCH_EVENT_MOVE) and (d_traceNext[slot] < d_traceSize) and (d_traceStamp(d_traceNext[slot]) <= d_traceChrono))
+        {
+            continue;
+        }
+
+        for (uint8_t index = 0; index < 7; index += 1)
+        {
+            payload[index] = (index < record[5]) ? record[TRACE_SIZE_RECORD + index] : 0x00;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+uint32_t Pervasive_Touch_Small::d_traceFind(uint8_t type, uint32_t position)
+{
+    // Records complete up to d_traceSize, checked by beginTouchReplay()
+    while ((position < d_traceSize) and (d_traceReplay[position] != type))
+    {
+        position += TRACE_SIZE_RECORD + d_traceReplay[position + 5];
+    }
+    return position;
+}
+
+uint32_t Pervasive_Touch_Small::d_traceStamp(uint32_t position)
+{
+    FRAMEBUFFER_CONST_TYPE record = d_traceReplay + position;
+    return record[1] | ((uint32_t)record[2] << 8) | ((uint32_t)record[3] << 16) | ((uint32_t)record[4] << 24);
+}
+/// @endcond
+//
+// === End of Trace section
+//
+
+//
+// === SPI clock section
+//
+#define SPEED_SPI_CHECKED 16000000 // Highest clock checked by calibrateSpeedSPI()
+
+void Pervasive_Touch_Small::setSpeedSPI(uint32_t speed)
+{
+    s_speedSPI = speed;
+    hV_HAL_SPI_end(); // Next hV_HAL_SPI_begin() takes new clock
+}
+
+uint32_t Pervasive_Touch_Small::getSpeedSPI()
+{
+    return s_speedSPI;
+}
+
+uint32_t Pervasive_Touch_Small::getThroughputSPI()
+{
+    return s_throughputSPI;
+}
+
+uint32_t Pervasive_Touch_Small::calibrateSpeedSPI(uint32_t speedMaximum)
+{
+    const uint32_t speeds[] = { 4000000, 8000000, 12000000, 16000000 };
+    uint32_t speedSafe = 0;
+    uint32_t throughputSafe = 0;
+
+    // 4-wire SPI has no read-back, faster clocks can't be checked
+    if (speedMaximum > SPEED_SPI_CHECKED)
+    {
+        hV_HAL_log(LEVEL_WARNING, "SPI calibration limited to %i Hz", SPEED_SPI_CHECKED);
+        speedMaximum = SPEED_SPI_CHECKED;
+    }
+
+    b_resume(); // GPIO
+
+    for (uint8_t index = 0; index < sizeof(speeds) / sizeof(speeds[0]); index += 1)
+    {
+        uint32_t throughput = 0;
+
+        if ((speeds[index] > speedMaximum) or (COG_checkSpeedSPI(speeds[index], throughput) == false))
+        {
+            break;
+        }
+
+        speedSafe = speeds[index];
+        throughputSafe = throughput;
+    }
+
+    // Restore state
+    hV_HAL_SPI_end();
+    COG_reset();
+
+    if (speedSafe == 0)
+    {
+        hV_HAL_log(LEVEL_ERROR, "SPI calibration failed, clock kept at %i Hz", s_speedSPI);
+        return s_speedSPI;
+    }
+
+    s_speedSPI = speedSafe;
+    s_throughputSPI = throughputSafe;
+    hV_HAL_log(LEVEL_INFO, "SPI calibration %i Hz, %i bytes/s", s_speedSPI, s_throughputSPI);
+    return s_speedSPI;
+}
+
+/// @cond NOT_PUBLIC
+bool Pervasive_Touch_Small::COG_checkSpeedSPI(uint32_t speed, uint32_t & throughput)
+{
+    // Commands sent at the clock, acknowledged by BUSY
+    uint32_t sizeFrame = (uint32_t)s_sizeX * s_sizeY / 8;
+
+    hV_HAL_SPI_end();
+    COG_reset();
+    hV_HAL_SPI_begin(speed);
+
+    COG_initial(UPDATE_NORMAL);
+
+    uint32_t chrono = hV_HAL_getMicroseconds();
+    b_sendIndexFixed(0x10, 0x55, sizeFrame);
+    b_sendIndexFixed(0x13, 0xaa, sizeFrame);
+    chrono = hV_HAL_getMicroseconds() - chrono;
+    throughput = (uint64_t)sizeFrame * 2 * 1000000 / ((chrono > 0) ? chrono : 1);
+
+    // Power on and DC/DC off without refresh
+    b_sendCommand8(0x04); // Power on
+    bool flagPassed = COG_checkBusy(200);
+    b_sendCommand8(0x02); // Turn off DC/DC
+    flagPassed = COG_checkBusy(200) and flagPassed;
+
+    if (flagPassed == false)
+    {
+        hV_HAL_log(LEVEL_WARNING, "SPI check failed at %i Hz", speed);
+        return false;
+    }
+
+    hV_HAL_log(LEVEL_DEBUG, "SPI check passed at %i Hz, %i bytes/s", speed, throughput);
+    return true;
+}
+
+bool Pervasive_Touch_Small::COG_checkBusy(uint32_t timeout)
+{
+    // Command acknowledged if BUSY goes low, then high before timeout in ms
+    bool flagLow = false;
+    uint32_t chrono = hV_HAL_getMilliseconds();
+
+    while (hV_HAL_getMilliseconds() - chrono < timeout)
+    {
+        if (hV_HAL_GPIO_get(b_pin.panelBusy) == LOW)
+        {
+            flagLow = true;
+        }
+        else if (flagLow)
+        {
+            return true;
+        }
+        hV_HAL_delayMicroseconds(100);
+    }
+    return false;
+}
+/// @endcond
+//
+// === End of SPI clock section
+//
+
+//
+// === Fingerprint section
+//
+bool Pervasive_Touch_Small::updateNormalIfChanged(FRAMEBUFFER_CONST_TYPE frame, uint32_t sizeFrame)
+{
+    // Rejected by updateNormal()
+    if (sizeFrame != (uint32_t)s_sizeX * s_sizeY / 8)
+    {
+        hV_HAL_log(LEVEL_ERROR, "Frame size %i, expected %i", sizeFrame, s_sizeX * s_sizeY / 8);
+        return false;
+    }
+
+    // Skip reset, OTP, SPI and refresh altogether
+    if ((s_fingerprint != 0) and (d_getFingerprint(frame, sizeFrame) == s_fingerprint))
+    {
+        return false;
+    }
+
+    updateNormal(frame, sizeFrame);
+    return true;
+}
+
+uint32_t Pervasive_Touch_Small::getFingerprint()
+{
+    return s_fingerprint;
+}
+
+void Pervasive_Touch_Small::setFingerprint(uint32_t fingerprint)
+{
+    s_fingerprint = fingerprint;
+}
+
+/// @cond NOT_PUBLIC
+uint32_t Pervasive_Touch_Small::d_getFingerprint(FRAMEBUFFER_CONST_TYPE frame, uint32_t sizeFrame)
+{
+    // FNV-1a, 32-bit, seeded with screen and orientation
+    uint32_t hash = 0x811c9dc5;
+    uint8_t seed[5] = { (uint8_t)u_eScreen_EPD, (uint8_t)(u_eScreen_EPD >> 8), (uint8_t)(u_eScreen_EPD >> 16), (uint8_t)(u_eScreen_EPD >> 24), s_frameOrientation };
+
+    for (uint8_t index = 0; index < 5; index += 1)
+    {
+        hash = (hash ^ seed[index]) * 0x01000193;
+    }
+    for (uint32_t index = 0; index < sizeFrame; index += 1)
+    {
+        hash = (hash ^ frame[index]) * 0x01000193;
+    }
+
+    return (hash != 0) ? hash : 1; // 0 is reserved for unknown
+}
+/// @endcond
+//
+// === End of Fingerprint section
+//
+
+//
+// === Touch filter section
+//
+void Pervasive_Touch_Small::setTouchFilter(uint8_t median, uint8_t smoothing, uint8_t deadZone)
+{
+    d_filterMedian = (median >= 5) ? 5 : ((median >= 3) ? 3 : 1);
+    d_filterSmoothing = smoothing;
+    d_filterDeadZone = deadZone;
+
+    d_filterCount = 0;
+    d_filterJitterSum = 0;
+    d_filterJitterCount = 0;
+    d_filterSuppressed = 0;
+}
+
+uint16_t Pervasive_Touch_Small::getTouchJitter()
+{
+    return (d_filterJitterCount > 0) ? d_filterJitterSum / d_filterJitterCount : 0;
+}
+
+uint32_t Pervasive_Touch_Small::getTouchSuppressed()
+{
+    return d_filterSuppressed;
+}
+
+/// @cond NOT_PUBLIC
+static uint16_t median5(const uint16_t * values, uint8_t number)
+{
+    // Insertion sort, number <= 5
+    uint16_t sorted[5];
+    for (uint8_t i = 0; i < number; i += 1)
+    {
+        uint16_t value = values[i];
+        uint8_t j = i;
+        while ((j > 0) and (sorted[j - 1] > value))
+        {
+            sorted[j] = sorted[j - 1];
+            j -= 1;
+        }
+        sorted[j] = value;
+    }
+    return sorted[number / 2];
+}
+
+void Pervasive_Touch_Small::d_filterTouch(touch_t & touch)
+{
+    if ((d_filterMedian == 1) and (d_filterSmoothing == 0) and (d_filterDeadZone == 0))
+    {
+        return;
+    }
+
+    switch (touch.t)
+    {
+        case TOUCH_EVENT_PRESS:
+
+            // Restart from first sample
+            d_filterCount = 1;
+            d_filterIndex = 0;
+            d_filterX[0] = touch.x;
+            d_filterY[0] = touch.y;
+            d_filterSmoothX = (uint32_t)touch.x << 4;
+            d_filterSmoothY = (uint32_t)touch.y << 4;
+            d_filterLastX = touch.x;
+            d_filterLastY = touch.y;
+            break;
+
+        case TOUCH_EVENT_MOVE:
+        {
+            // Filter set during contact, restart from this sample
+            if (d_filterCount == 0)
+            {
+                d_filterIndex = d_filterMedian - 1;
+                d_filterSmoothX = (uint32_t)touch.x << 4;
+                d_filterSmoothY = (uint32_t)touch.y << 4;
+                d_filterLastX = touch.x;
+                d_filterLastY = touch.y;
+            }
+
+            // Median of last samples
+            d_filterIndex = (d_filterIndex + 1) % d_filterMedian;
+            d_filterX[d_filterIndex] = touch.x;
+            d_filterY[d_filterIndex] = touch.y;
+            d_filterCount = (d_filterCount < d_filterMedian) ? d_filterCount + 1 : d_filterMedian;
+
+            uint32_t x = (uint32_t)median5(d_filterX, d_filterCount) << 4;
+            uint32_t y = (uint32_t)median5(d_filterY, d_filterCount) << 4;
+
+            // Exponential smoothing, weight / 256
+            if (d_filterSmoothing > 0)
+            {
+                x = d_filterSmoothX + (((int32_t)x - (int32_t)d_filterSmoothX) * d_filterSmoothing) / 256;
+                y = d_filterSmoothY + (((int32_t)y - (int32_t)d_filterSmoothY) * d_filterSmoothing) / 256;
+            }
+            d_filterSmoothX = x;
+            d_filterSmoothY = y;
+
+            // Jitter, raw against filtered
+            uint32_t rawX = (uint32_t)touch.x << 4;
+            uint32_t rawY = (uint32_t)touch.y << 4;
+            d_filterJitterSum += ((rawX > x) ? rawX - x : x - rawX) + ((rawY > y) ? rawY - y : y - rawY);
+            d_filterJitterCount += 1;
+
+            // Rounded to counts
+            uint16_t filteredX = (x + 8) >> 4;
+            uint16_t filteredY = (y + 8) >> 4;
+
+            // Dead-zone against last reported position
+            uint16_t deltaX = (filteredX > d_filterLastX) ? filteredX - d_filterLastX : d_filterLastX - filteredX;
+            uint16_t deltaY = (filteredY > d_filterLastY) ? filteredY - d_filterLastY : d_filterLastY - filteredY;
+            if ((deltaX <= d_filterDeadZone) and (deltaY <= d_filterDeadZone))
+            {
+                touch.t = TOUCH_EVENT_NONE;
+                d_filterSuppressed += 1;
+                break;
+            }
+
+            touch.x = filteredX;
+            touch.y = filteredY;
+            d_filterLastX = filteredX;
+            d_filterLastY = filteredY;
+        }
+        break;
+
+        case TOUCH_EVENT_RELEASE:
+
+            // Release at last reported position
+            if (d_filterCount > 0)
+            {
+                touch.x = d_filterLastX;
+                touch.y = d_filterLastY;
+                d_filterCount = 0;
+            }
+            break;
+
+        default:
+
+            break;
+    }
+}
+/// @endcond
+//
+// === End of Touch filter section
+//
+
+//
+// === Touch regions section
+//
+#define REGION_CELL_SHIFT 5 // 32x32 cells
+#define REGION_CELLS_X 8 // 240 / 32, rounded up
+
+uint8_t Pervasive_Touch_Small::addTouchRegion(uint8_t identifier, uint16_t x0, uint16_t y0, uint16_t dx, uint16_t dy)
+{
+    if ((identifier >= REGION_NUMBER) or (dx == 0) or (dy == 0) or (x0 >= s_sizeX) or (y0 >= s_sizeY))
+    {
+        hV_HAL_log(LEVEL_ERROR, "Touch region %i not valid", identifier);
+        return RESULT_ERROR;
+    }
+
+    removeTouchRegion(identifier);
+
+    d_regionX0[identifier] = x0;
+    d_regionY0[identifier] = y0;
+    d_regionX1[identifier] = (dx < s_sizeX - x0) ? x0 + dx : s_sizeX;
+    d_regionY1[identifier] = (dy < s_sizeY - y0) ? y0 + dy : s_sizeY;
+    d_markTouchRegion(identifier, true);
+
+    return RESULT_SUCCESS;
+}
+
+void Pervasive_Touch_Small::removeTouchRegion(uint8_t identifier)
+{
+    if (identifier < REGION_NUMBER)
+    {
+        d_markTouchRegion(identifier, false);
+    }
+}
+
+uint8_t Pervasive_Touch_Small::getTouchRegion(touch_t touch)
+{
+    if ((touch.x >= s_sizeX) or (touch.y >= s_sizeY))
+    {
+        return REGION_NONE;
+    }
+
+    // Candidates from the cell, then exact check, highest identifier first
+    uint32_t candidates = d_regionCells[(touch.y >> REGION_CELL_SHIFT) * REGION_CELLS_X + (touch.x >> REGION_CELL_SHIFT)];
+
+    while (candidates > 0)
+    {
+        uint8_t identifier = 31;
+        while ((candidates & ((uint32_t)1 << identifier)) == 0)
+        {
+            identifier -= 1;
+        }
+
+        if ((touch.x >= d_regionX0[identifier]) and (touch.x < d_regionX1[identifier])
+                and (touch.y >= d_regionY0[identifier]) and (touch.y < d_regionY1[identifier]))
+        {
+            return identifier;
+        }
+        candidates &= ~((uint32_t)1 << identifier);
+    }
+
+    return REGION_NONE;
+}
+
+/// @cond NOT_PUBLIC
+void Pervasive_Touch_Small::d_markTouchRegion(uint8_t identifier, bool flagSet)
+{
+    uint32_t mask = (uint32_t)1 << identifier;
+
+    if (flagSet == false)
+    {
+        // Clear everywhere, region may be unknown
+        for (uint8_t cell = 0; cell < sizeof(d_regionCells) / sizeof(d_regionCells[0]); cell += 1)
+        {
+            d_regionCells[cell] &= ~mask;
+        }
+        return;
+    }
+
+    for (uint16_t cellY = d_regionY0[identifier] >> REGION_CELL_SHIFT; cellY <= ((d_regionY1[identifier] - 1) >> REGION_CELL_SHIFT); cellY += 1)
+    {
+        for (uint16_t cellX = d_regionX0[identifier] >> REGION_CELL_SHIFT; cellX <= ((d_regionX1[identifier] - 1) >> REGION_CELL_SHIFT); cellX += 1)
+        {
+            d_regionCells[cellY * REGION_CELLS_X + cellX] |= mask;
+        }
+    }
+}
+/// @endcond
+//
+// === End of Touch regions section
+//
+
+//
+// === Touch polling section
+//
+void Pervasive_Touch_Small::setTouchPolling(uint16_t periodActive, uint16_t periodIdle, bool flagInterruptIdle)
+{
+    d_pollActive = (periodActive > 0) ? periodActive : 1;
+    d_pollIdle = (periodIdle > d_pollActive) ? periodIdle : d_pollActive;
+    d_pollInterruptIdle = flagInterruptIdle;
+    d_pollPeriod = d_pollActive;
+
+    // INT not used by the parser, so no interrupt-only idle polling
+    if ((SCREEN_SIZE(u_eScreen_EPD) == SIZE_271) and flagInterruptIdle)
+    {
+        hV_HAL_log(LEVEL_WARNING, "Touch polling on interrupt not available on 2.71\"");
+        d_pollInterruptIdle = false;
+    }
+
+    d_pollStart = hV_HAL_getMilliseconds();
+    d_pollLast = d_pollStart - d_pollPeriod; // Due now
+    d_pollCount = 0;
+    d_pollTransactions = d_touchTransactions;
+}
+
+bool Pervasive_Touch_Small::pollTouch(touch_t & touch)
+{
+    uint32_t chrono = hV_HAL_getMilliseconds();
+    bool flagIdle = (d_touchPrevious == TOUCH_EVENT_NONE);
+    d_addEnergyIdle(chrono);
+
+    if (flagIdle and (d_pollPeriod >= d_pollIdle) and d_pollInterruptIdle)
+    {
+        // Interrupt only, GPIO read without I2C
+        if (d_getInterruptTouch() == false)
+        {
+            return false;
+        }
+    }
+    else if ((chrono - d_pollLast) < d_pollPeriod)
+    {
+        // Interrupt while idle, poll now for latency
+        if ((flagIdle == false) or (d_getInterruptTouch() == false))
+        {
+            return false;
+        }
+    }
+
+    d_getRawTouch(touch);
+    d_pollLast = chrono;
+    d_pollCount += 1;
+
+    // Fast during contact, then slower up to idle period
+    if ((touch.t != TOUCH_EVENT_NONE) or (d_touchPrevious != TOUCH_EVENT_NONE))
+    {
+        d_pollPeriod = d_pollActive;
+    }
+    else if (d_pollPeriod < d_pollIdle)
+    {
+        d_pollPeriod = (d_pollPeriod < d_pollIdle / 2) ? d_pollPeriod * 2 : d_pollIdle;
+    }
+
+    return true;
+}
+
+uint32_t Pervasive_Touch_Small::getTouchPollsPerMinute()
+{
+    uint32_t elapsed = hV_HAL_getMilliseconds() - d_pollStart;
+    return (elapsed > 0) ? (uint32_t)((uint64_t)d_pollCount * 60000 / elapsed) : 0;
+}
+
+uint32_t Pervasive_Touch_Small::getTouchTransactionsPerMinute()
+{
+    uint32_t elapsed = hV_HAL_getMilliseconds() - d_pollStart;
+    return (elapsed > 0) ? (uint32_t)((uint64_t)(d_touchTransactions - d_pollTransactions) * 60000 / elapsed) : 0;
+}
+//
+// === End of Touch polling section
+//
+
+//
+// === Power policy section
+//
+void Pervasive_Touch_Small::setPowerPolicy(uint32_t periodKeep, uint32_t periodRelease)
+{
+    s_policyKeep = periodKeep;
+    s_policyRelease = (periodRelease > periodKeep) ? periodRelease : periodKeep;
+    s_policyAvoided = 0;
+    s_policySuspended = 0;
+}
+
+uint32_t Pervasive_Touch_Small::getPowerAvoided()
+{
+    return s_policyAvoided;
+}
+
+uint32_t Pervasive_Touch_Small::getPowerSuspended()
+{
+    return s_policySuspended;
+}
+
+/// @cond NOT_PUBLIC
+void Pervasive_Touch_Small::d_applyPowerPolicy()
+{
+    // Policy off
+    if (s_policyRelease == 0)
+    {
+        s_flagResident = false;
+        return;
+    }
+
+    // Hysteresis between periodKeep and periodRelease
+    // Touch controller left to the application, see suspendTouch() and resumeTouch()
+    if ((s_flagResident == false) and (s_updatePeriod > 0) and (s_updatePeriod < s_policyKeep))
+    {
+        s_flagResident = true;
+    }
+    else if ((s_flagResident == true) and (s_updatePeriod > s_policyRelease))
+    {
+        s_flagResident = false;
+    }
+
+    if (s_flagResident == false)
+    {
+        hV_HAL_SPI_end();
+        b_suspend(); // GPIO
+        s_policySuspended += 1;
+    }
+}
+/// @endcond
+//
+// === End of Power policy section
+//
+
+//
+// === Energy section
+//
+void Pervasive_Touch_Small::setEnergyCurrents(const uint16_t * currents)
+{
+    for (uint8_t index = 0; index < CURRENT_NUMBER; index += 1)
+    {
+        d_energyCurrents[index] = currents[index];
+    }
+}
+
+uint32_t Pervasive_Touch_Small::getEnergy(uint8_t item)
+{
+    return (item < ENERGY_NUMBER) ? (uint32_t)(d_energyCharges[item] / 1000) : 0;
+}
+
+uint32_t Pervasive_Touch_Small::getEnergyCount(uint8_t item)
+{
+    return (item < ENERGY_NUMBER) ? d_energyCounts[item] : 0;
+}
+
+void Pervasive_Touch_Small::resetEnergy()
+{
+    for (uint8_t index = 0; index < ENERGY_NUMBER; index += 1)
+    {
+        d_energyCharges[index] = 0;
+        d_energyCounts[index] = 0;
+    }
+}
+
+/// @cond NOT_PUBLIC
+void Pervasive_Touch_Small::d_addEnergy(uint8_t item, uint8_t current, uint32_t duration)
+{
+    // uA * ms = nC
+    d_energyCharges[item] += (uint64_t)d_energyCurrents[current] * duration;
+}
+
+void Pervasive_Touch_Small::d_addEnergyIdle(uint32_t chrono)
+{
+    // Controller active since last poll, charged to the polling mode
+    if ((d_energyIdleStart > 0) and (d_touchPower == TOUCH_POWER_ACTIVE) and (d_traceMode != TRACE_REPLAY))
+    {
+        uint8_t itemTouch = d_pollInterruptIdle ? ENERGY_TOUCH_INTERRUPT : ENERGY_TOUCH_POLLED;
+        d_addEnergy(itemTouch, CURRENT_TOUCH_IDLE, chrono - d_energyIdleStart);
+    }
+    d_energyIdleStart = (chrono > 0) ? chrono : 1;
+}
+/// @endcond
+//
+// === End of Energy section
+//
+
+//
+// === Temperature section
+//
+void Pervasive_Touch_Small::setTemperatureProvider(temperatureProvider_t provider, uint32_t periodRefresh,
+        uint8_t hysteresis, uint32_t periodStale)
+{
+    s_temperatureProvider = provider;
+    s_temperatureRefresh = periodRefresh;
+    s_temperatureHysteresis = hysteresis;
+    s_temperatureStale = (periodStale > periodRefresh) ? periodStale : periodRefresh;
+
+    s_temperatureLast = 0;
+    s_temperatureQuery = 0;
+    s_temperatureHits = 0;
+    s_temperatureMisses = 0;
+}
+
+uint32_t Pervasive_Touch_Small::getTemperatureHits()
+{
+    return s_temperatureHits;
+}
+
+uint32_t Pervasive_Touch_Small::getTemperatureMisses()
+{
+    return s_temperatureMisses;
+}
+
+/// @cond NOT_PUBLIC
+void Pervasive_Touch_Small::d_refreshTemperature()
+{
+    if (s_temperatureProvider == nullptr)
+    {
+        return;
+    }
+
+    uint32_t chrono = hV_HAL_getMilliseconds();
+    chrono = (chrono > 0) ? chrono : 1;
+
+    // Cache hit, provider queried less than periodRefresh ago
+    if ((s_temperatureQuery > 0) and (chrono - s_temperatureQuery < s_temperatureRefresh))
+    {
+        s_temperatureHits += 1;
+        u_temperature = s_temperatureCached;
+        return;
+    }
+
+    s_temperatureMisses += 1;
+    s_temperatureQuery = chrono;
+    int8_t temperature = s_temperatureProvider();
+
+    if (temperature != TEMPERATURE_INVALID)
+    {
+        // Hysteresis band around cached value
+        int16_t delta = (int16_t)temperature - s_temperatureCached;
+        if ((s_temperatureLast == 0) or (delta >= s_temperatureHysteresis) or (-delta >= s_temperatureHysteresis))
+        {
+            s_temperatureCached = temperature;
+        }
+        s_temperatureLast = chrono;
+    }
+    else if ((s_temperatureLast == 0) or (chrono - s_temperatureLast > s_temperatureStale))
+    {
+        hV_HAL_log(LEVEL_WARNING, "Temperature not available, 25 Celsius used");
+        s_temperatureCached = 25;
+    }
+
+    u_temperature = s_temperatureCached;
+}
+/// @endcond
+//
+// === End of Temperature section
+//
+
+//
+// === Touch section
+//
+void Pervasive_Touch_Small::d_beginTouch()
+{
+    // v_touchTrim = 0x10; // standard threshold
+    // v_touchEvent = true;
+
+    // Target   FSM_ON
+    // Source   FSM_OFF -> FSM_SLEEP
+    //          FSM_SLEEP
+    if (d_fsmPowerTouch == FSM_OFF)
+    {
+        hV_HAL_Wire_begin();
+
+#if (DEBUG_POWER > 0)
+
+        hV_HAL_log(LEVEL_DEBUG, "%24s %4s I2C.GPIO %02x -> %02x", "d_beginTouch", "I2C", d_fsmPowerTouch, (d_fsmPowerTouch | FSM_SLEEP));
+
+#endif // DEBUG_POWER
+
+        d_fsmPowerTouch |= FSM_BUS_MASK;
+    }
+
+    // if (b_pin.touchInt != NOT_CONNECTED) already tested
+    hV_HAL_GPIO_define(b_pin.touchInt, INPUT_PULLUP);
+
+    // if (b_pin.touchReset != NOT_CONNECTED) already tested
+    hV_HAL_GPIO_define(b_pin.touchReset, OUTPUT);
+    d_fsmPowerTouch |= FSM_GPIO_MASK;
+
+    if (SCREEN_SIZE(u_eScreen_EPD) == SIZE_271)
+    {
+        d_resetTouch();
+        d_touchAddress = TOUCH_271_ADDRESS; // 0x41
+
+        // // v_touchXmax and v_touchYmax read from controller
+        // uint8_t bufferWrite[1] = {0};
+        // uint8_t bufferRead[10] = {0};
+        //
+        // bufferWrite[0] = 0x20;
+        // hV_HAL_Wire_transfer(d_touchAddress, bufferWrite, 1, bufferRead, 10);
+        // v_touchXmin = 0;
+        // v_touchXmax = bufferRead[0] + (bufferRead[1] << 8); // Xmax
+        // v_touchYmin = 0;
+        // v_touchYmax = bufferRead[2] + (bufferRead[3] << 8); // Ymax
+
+        // // v_touchXmax and v_touchYmax hard-coded
+        // v_touchXmin = 0;
+        // v_touchXmax = 176; // Xmax
+        // v_touchYmin = 0;
+        // v_touchYmax = 264; // Ymax
+    }
+    // else if (SCREEN_SIZE(u_eScreen_EPD) == SIZE_343)
+    // {
+    //     hV_HAL_GPIO_set(b_pin.touchReset);
+    //     hV_HAL_delayMilliseconds(10);
+    //     hV_HAL_GPIO_clear(b_pin.touchReset);
+    //     hV_HAL_delayMilliseconds(10);
+    //     hV_HAL_GPIO_set(b_pin.touchReset);
+    //     hV_HAL_delayMilliseconds(1000);
+    //
+    //     d_touchAddress = TOUCH_343_ADDRESS; // 0x4A
+    //
+    //     // uint8_t bufferWrite[1] = {0};
+    //     // uint8_t bufferRead[4] = {0};
+    //     //
+    //     // bufferWrite[0] = 0xa6;
+    //     // hV_HAL_Wire_transfer(_touchAddress, bufferWrite, 1, bufferRead, 4);
+    //
+    //     // // v_touchXmax and v_touchYmax hard-coded
+    //     // v_touchXmin = 0;
+    //     // v_touchXmax = 455; // Xmax, hardware hard-coded
+    //     // v_touchYmin = 0;
+    //     // v_touchYmax = 391; // Ymax, hardware hard-coded
+    // }
+    else if (SCREEN_SIZE(u_eScreen_EPD) == SIZE_370)
+    {
+        d_resetTouch();
+        d_touchAddress = TOUCH_370_ADDRESS; // 0x38
+
+        // uint8_t bufferWrite[1] = {0};
+        // uint8_t bufferRead[4] = {0};
+        //
+        // bufferWrite[0] = 0xa6;
+        // hV_HAL_Wire_transfer(d_touchAddress, bufferWrite, 1, bufferRead, 4);
+
+        // // v_touchXmax and v_touchYmax hard-coded
+        // v_touchXmin = 0;
+        // v_touchXmax = 239; // Xmax, hardware hard-coded
+        // v_touchYmin = 0;
+        // v_touchYmax = 415; // Ymax, hardware hard-coded
+    }
+    d_touchPrevious = TOUCH_EVENT_NONE;
+    d_touchPower = TOUCH_POWER_ACTIVE;
+
+    // Target   FSM_ON
+    // Source   FSM_SLEEP -> FSM_ON
+
+#if (DEBUG_POWER > 0)
+
+    hV_HAL_log(LEVEL_DEBUG, "%24s %4s I2C.GPIO %02x -> %02x", "d_beginTouch", "GPIO", d_fsmPowerTouch, FSM_ON);
+
+#endif // DEBUG_POWER
+
+    d_fsmPowerTouch = FSM_ON;
+}
+
+void Pervasive_Touch_Small::d_resetTouch()
+{
+    if (SCREEN_SIZE(u_eScreen_EPD) == SIZE_271)
+    {
+        hV_HAL_GPIO_set(b_pin.touchReset);
+        hV_HAL_delayMilliseconds(100);
+        hV_HAL_GPIO_clear(b_pin.touchReset);
+        hV_HAL_delayMilliseconds(100);
+        hV_HAL_GPIO_set(b_pin.touchReset);
+        hV_HAL_delayMilliseconds(100);
+    }
+    else if (SCREEN_SIZE(u_eScreen_EPD) == SIZE_370)
+    {
+        hV_HAL_GPIO_set(b_pin.touchReset);
+        hV_HAL_delayMilliseconds(10);
+        hV_HAL_GPIO_clear(b_pin.touchReset);
+        hV_HAL_delayMilliseconds(10);
+        hV_HAL_GPIO_set(b_pin.touchReset);
+        hV_HAL_delayMilliseconds(1000);
+    }
+}
+
+void Pervasive_Touch_Small::suspendTouch(uint8_t mode)
+{
+    // Bus and GPIO kept, d_fsmPowerTouch stays FSM_ON, INT armed for wake-on-touch
+    if ((d_fsmPowerTouch != FSM_ON) or (d_touchPower != TOUCH_POWER_ACTIVE) or (mode == TOUCH_POWER_ACTIVE))
+    {
+        return;
+    }
+
+    uint8_t bufferWrite[2] = {0};
+
+    if (SCREEN_SIZE(u_eScreen_EPD) == SIZE_271)
+    {
+        // No low-power scan, INT not used by the parser, so no wake-on-touch
+        if (mode == TOUCH_POWER_MONITOR)
+        {
+            hV_HAL_log(LEVEL_WARNING, "Touch monitor not available on 2.71\"");
+            return;
+        }
+
+        bufferWrite[0] = 0x30; // Sleep, no wake-on-touch
+        hV_HAL_Wire_transfer(d_touchAddress, bufferWrite, 1, nullptr, 0);
+        d_touchTransactions += 1;
+    }
+    else if (SCREEN_SIZE(u_eScreen_EPD) == SIZE_370)
+    {
+        bufferWrite[0] = 0xa5; // Power mode
+        bufferWrite[1] = (mode == TOUCH_POWER_SLEEP) ? 0x03 : 0x01; // Hibernate or monitor
+        hV_HAL_Wire_transfer(d_touchAddress, bufferWrite, 2, nullptr, 0);
+        d_touchTransactions += 1;
+    }
+
+    // Contact in progress kept, release returned by next d_getRawTouch()
+    d_addEnergyIdle(hV_HAL_getMilliseconds());
+    d_touchPower = mode;
+    d_touchSuspendStart = hV_HAL_getMilliseconds();
+}
+
+void Pervasive_Touch_Small::resumeTouch()
+{
+    if (d_touchPower == TOUCH_POWER_ACTIVE)
+    {
+        return;
+    }
+
+    uint32_t chrono = hV_HAL_getMilliseconds();
+
+    if (d_touchPower == TOUCH_POWER_SLEEP)
+    {
+        d_resetTouch(); // /RESET to resume
+    }
+    else if (SCREEN_SIZE(u_eScreen_EPD) == SIZE_370) // TOUCH_POWER_MONITOR
+    {
+        uint8_t bufferWrite[2] = {0xa5, 0x00}; // Power mode, active
+        hV_HAL_Wire_transfer(d_touchAddress, bufferWrite, 2, nullptr, 0);
+        d_touchTransactions += 1;
+    }
+
+    d_touchStandby += chrono - d_touchSuspendStart;
+    d_addEnergy(ENERGY_TOUCH_STANDBY, CURRENT_TOUCH_STANDBY, chrono - d_touchSuspendStart);
+    d_energyCounts[ENERGY_TOUCH_STANDBY] += 1;
+    d_touchResume = hV_HAL_getMilliseconds() - chrono;
+    d_touchPower = TOUCH_POWER_ACTIVE;
+    d_energyIdleStart = hV_HAL_getMilliseconds();
+}
+
+uint8_t Pervasive_Touch_Small::getTouchPower()
+{
+    return d_touchPower;
+}
+
+uint32_t Pervasive_Touch_Small::getTouchStandbyTime()
+{
+    uint32_t standby = d_touchStandby;
+    if (d_touchPower != TOUCH_POWER_ACTIVE)
+    {
+        standby += hV_HAL_getMilliseconds() - d_touchSuspendStart;
+    }
+    return standby;
+}
+
+uint32_t Pervasive_Touch_Small::getTouchResumeTime()
+{
+    return d_touchResume;
+}
+
+void Pervasive_Touch_Small::d_getRawTouch(touch_t & touch)
+{
+    // Wake-on-touch from monitor, no event from sleep
+    if ((d_touchPower != TOUCH_POWER_ACTIVE) and (d_traceMode != TRACE_REPLAY))
+    {
+        if ((d_touchPower == TOUCH_POWER_MONITOR) and (hV_HAL_GPIO_get(b_pin.touchInt) == LOW))
+        {
+            resumeTouch();
+        }
+        else
+        {
+            touch.t = TOUCH_EVENT_NONE;
+            touch.z = 0;
+
+            // Contact in progress when suspended, release at last position
+            if (d_touchPrevious != TOUCH_EVENT_NONE)
+            {
+                d_touchPrevious = TOUCH_EVENT_NONE;
+                touch.t = TOUCH_EVENT_RELEASE;
+                touch.x = d_touchX;
+                touch.y = d_touchY;
+                touch.z = 0x16;
+                d_stampTouchEvent(false, touch.t);
+                d_filterTouch(touch);
+            }
+            return;
+        }
+    }
+    bool flagValid = false;
+
+    if (d_traceMode != 0)
+    {
+        d_traceTick(true);
+    }
+
+    if ((d_traceMode == TRACE_REPLAY) and ((d_traceScope & TRACE_WIRE) == 0))
+    {
+        // Trace without I2C records, recorded results returned as is
+        uint8_t payload[7];
+        touch.t = TOUCH_EVENT_NONE;
+        touch.z = 0;
+
+        if (d_traceReadEvent(payload))
+        {
+            touch.x = payload[0] | (payload[1] << 8);
+            touch.y = payload[2] | (payload[3] << 8);
+            touch.z = payload[4] | (payload[5] << 8);
+            touch.t = payload[6];
+        }
+        if (touch.t == TOUCH_EVENT_PRESS)
+        {
+            d_tracePressesReplayed += 1;
+        }
+        d_filterTouch(touch);
+        return;
+    }
+
+    uint32_t chrono = hV_HAL_getMilliseconds();
+    uint8_t flagInterrupt = 1 - d_readInterrupt();
+    if (d_traceMode != TRACE_REPLAY)
+    {
+        hV_HAL_delayMilliseconds(10);
+    }
+
+    if (SCREEN_SIZE(u_eScreen_EPD) == SIZE_271)
+    {
+        uint8_t bufferWrite[1] = {0};
+        uint8_t bufferRead[5] = {0};
+
+        bufferWrite[0] = 0x10; // check
+        d_readTouch(bufferWrite[0], bufferRead, 1);
+
+        uint8_t number = bufferRead[0];
+        touch.z = 0;
+        touch.t = TOUCH_EVENT_NONE;
+
+        // Only one finger read, flagInterrupt not used
+        // if ((number > 0) and (number < 3) and (flagInterrupt > 0))
+        if ((number > 0) and (number < 3))
+        {
+            bufferWrite[0] = 0x11; // report
+            d_readTouch(bufferWrite[0], bufferRead, 5);
+
+            uint8_t status = bufferRead[0];
+            touch.x = (bufferRead[1] << 8) + bufferRead[2];
+            touch.y = (bufferRead[3] << 8) + bufferRead[4];
+
+            if (status & 0x80) // touch
+            {
+                touch.t = (d_touchPrevious != TOUCH_EVENT_NONE) ? TOUCH_EVENT_MOVE : TOUCH_EVENT_PRESS;
+
+                // Keep position for next release
+                d_touchPrevious = TOUCH_EVENT_PRESS;
+                d_touchX = touch.x;
+                d_touchY = touch.y;
+            }
+            else
+            {
+                touch.t = TOUCH_EVENT_RELEASE;
+            }
+            touch.z = 0x16;
+        }
+        else // no touch
+        {
+            if (d_touchPrevious == TOUCH_EVENT_NONE)
+            {
+                touch.t = TOUCH_EVENT_NONE;
+                touch.z = 0;
+            }
+            else // Take previous position for release
+            {
+                d_touchPrevious = TOUCH_EVENT_NONE;
+                touch.t = TOUCH_EVENT_RELEASE;
+                touch.x = d_touchX;
+                touch.y = d_touchY;
+                touch.z = 0x16;
+            }
+        }
+    }
+    // else if (SCREEN_SIZE(u_eScreen_EPD) == SIZE_343)
+    // {
     //     touch.z = 0;
     //     touch.t = TOUCH_EVENT_NONE;
     //
@@ -792,7 +2685,7 @@ void Pervasive_Touch_Small::d_getRawTouch(touch_t & touch)
             uint8_t bufferRead[3 + 6];
 
             bufferWrite[0] = 0x00;
-            hV_HAL_Wire_transfer(d_touchAddress, bufferWrite, 1, bufferRead, 3 + 6); // report
+            d_readTouch(bufferWrite[0], bufferRead, 3 + 6); // report
 
             // char * stringEvent[] = {"Down", "Up", "Contact", "Reserved"};
             // uint8_t event = bufferRead[3 + 6 * 0 + 0] >> 6;
@@ -834,6 +2727,61 @@ void Pervasive_Touch_Small::d_getRawTouch(touch_t & touch)
             }
         }
     } // u_eScreen_EPD
+
+    d_stampTouchEvent(flagInterrupt > 0, touch.t);
+
+    if (d_traceMode != TRACE_REPLAY)
+    {
+        // Charged to the polling mode, not to the INT level of this poll
+        uint8_t itemTouch = d_pollInterruptIdle ? ENERGY_TOUCH_INTERRUPT : ENERGY_TOUCH_POLLED;
+        d_addEnergy(itemTouch, CURRENT_TOUCH_ACTIVE, hV_HAL_getMilliseconds() - chrono);
+        d_energyCounts[itemTouch] += 1;
+        d_energyIdleStart = hV_HAL_getMilliseconds();
+    }
+
+    if (touch.t != TOUCH_EVENT_NONE)
+    {
+        uint8_t payload[7];
+
+        if (d_traceMode == TRACE_RECORD)
+        {
+            payload[0] = touch.x;
+            payload[1] = touch.x >> 8;
+            payload[2] = touch.y;
+            payload[3] = touch.y >> 8;
+            payload[4] = touch.z;
+            payload[5] = touch.z >> 8;
+            payload[6] = touch.t;
+            d_traceWrite(TRACE_TOUCH, payload, 7);
+        }
+        else if (d_traceMode == TRACE_REPLAY)
+        {
+            // Check parser result against latest recorded result
+            // Press and move may swap with the polling period, and so the position of a release
+            bool flagMatch = d_traceRead(TRACE_TOUCH, payload, 7);
+            if (touch.t == TOUCH_EVENT_RELEASE)
+            {
+                flagMatch = flagMatch and (payload[6] == TOUCH_EVENT_RELEASE);
+            }
+            else
+            {
+                flagMatch = flagMatch and (payload[6] != TOUCH_EVENT_RELEASE)
+                            and (touch.x == (payload[0] | (payload[1] << 8)))
+                            and (touch.y == (payload[2] | (payload[3] << 8)));
+            }
+
+            if (flagMatch == false)
+            {
+                d_traceMismatches += 1;
+            }
+            if (touch.t == TOUCH_EVENT_PRESS)
+            {
+                d_tracePressesReplayed += 1;
+            }
+        }
+    }
+
+    d_filterTouch(touch);
 }
 
 bool Pervasive_Touch_Small::d_getInterruptTouch()
@@ -841,7 +2789,21 @@ bool Pervasive_Touch_Small::d_getInterruptTouch()
     // if (b_pin.touchInt != NOT_CONNECTED) already tested
     // Translate for true = interrupt
     // 271, 343 and 370: LOW = false for interrupt
-    return (hV_HAL_GPIO_get(b_pin.touchInt) == LOW);
+    if (d_traceMode != 0)
+    {
+        d_traceTick(false);
+    }
+    uint32_t chrono = hV_HAL_getMilliseconds();
+    bool flagInterrupt = (d_readInterrupt() == LOW);
+    d_stampTouchEvent(flagInterrupt, TOUCH_EVENT_NONE);
+
+    if (d_traceMode != TRACE_REPLAY)
+    {
+        d_addEnergy(ENERGY_TOUCH_CHECK, CURRENT_TOUCH_ACTIVE, hV_HAL_getMilliseconds() - chrono);
+        d_energyCounts[ENERGY_TOUCH_CHECK] += 1;
+        d_energyIdleStart = hV_HAL_getMilliseconds();
+    }
+    return flagInterrupt;
 }
 //
 // === End of Touch section
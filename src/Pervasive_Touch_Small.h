@@ -7,8 +7,8 @@
 /// * ApplicationNote_Small_Size_wide-Temperature_EPD_v03_20231031_B
 /// * ApplicationNote_Small_Size_wide-Temperature_EPD_v01_20231225_A
 ///
-/// @date 21 May 2025
-/// @version 909
+/// @date 19 Oct 2026
+/// @version 910
 ///
 /// @copyright (c) Pervasive Displays Inc., 2021-2026
 /// @copyright All rights reserved
@@ -47,7 +47,7 @@
 ///
 /// @brief Library release number
 ///
-#define DRIVER_TOUCH_SMALL_RELEASE 909
+#define DRIVER_TOUCH_SMALL_RELEASE 910
 
 ///
 /// @name List of supported screens
@@ -74,6 +74,103 @@
 #define WITH_TOUCH ///< With touch capability
 /// @}
 
+///
+/// @name Packing modes for grey-level frames
+/// @details One byte per pixel, 0x00 = black, 0xff = white
+/// @{
+///
+#define PACKING_THRESHOLD 0x00 ///< Fixed threshold
+#define PACKING_ORDERED 0x01 ///< Ordered dithering, 4x4 Bayer matrix
+#define PACKING_DIFFUSION 0x02 ///< Error diffusion, Floyd-Steinberg
+/// @}
+
+///
+/// @name Time stamps
+/// @details Touch stamps of the touch served by the last update, then phases of the last update
+/// @{
+///
+#define STAMP_INTERRUPT 0 ///< Touch interrupt edge
+#define STAMP_TOUCH 1 ///< Press event from d_getRawTouch()
+#define STAMP_SUBMIT 2 ///< Frame submitted
+#define STAMP_RESET 3 ///< Application note § 2. Power on COG driver
+#define STAMP_OTP 4 ///< Application note § 3. Read OTP memory, only when required
+#define STAMP_INITIAL 5 ///< Application note § 4. Input initial command
+#define STAMP_DATA 6 ///< Application note § 5. Input image to the EPD
+#define STAMP_POWER 7 ///< Application note § 6. Power on
+#define STAMP_REFRESH 8 ///< Application note § 6. Display refresh
+#define STAMP_DCDC 9 ///< BUSY released, application note § 7. Turn-off DC/DC
+#define STAMP_END 10 ///< End of update
+#define STAMP_NUMBER 11 ///< Number of stamps
+/// @}
+
+///
+/// @name Touch trace
+/// @details Header "PTT" + version, then records
+/// @n Record = type, time in ms since start of record (4 bytes, little-endian), length, payload
+/// @n Records of the same poll share the time of the poll
+/// @{
+///
+#define TRACE_TOUCH 0x01 ///< touch_t result from d_getRawTouch(), x y z (2 bytes each) t
+#define TRACE_INTERRUPT 0x02 ///< INT pin level, on change only
+#define TRACE_WIRE 0x04 ///< I2C address, register, then bytes read
+#define TRACE_ALL 0x07 ///< All records
+/// @}
+
+///
+/// @name Touch regions
+/// @{
+///
+#define REGION_NUMBER 32 ///< Identifiers 0 to 31
+#define REGION_NONE 0xff ///< No region
+/// @}
+
+///
+/// @name Touch controller power modes
+/// @{
+///
+#define TOUCH_POWER_ACTIVE 0x00 ///< Active
+#define TOUCH_POWER_MONITOR 0x01 ///< Low-power scan, wake-on-touch, fast resume, 3.70" only
+#define TOUCH_POWER_SLEEP 0x02 ///< Lowest power, no wake-on-touch, /RESET to resume
+/// @}
+
+///
+/// @name Energy model, currents
+/// @details Calibration table, one current in uA per item, specific to each board
+/// @{
+///
+#define CURRENT_RESET 0 ///< Phase from STAMP_RESET
+#define CURRENT_OTP 1 ///< Phase from STAMP_OTP
+#define CURRENT_INITIAL 2 ///< Phase from STAMP_INITIAL
+#define CURRENT_DATA 3 ///< Phase from STAMP_DATA
+#define CURRENT_POWER 4 ///< Phase from STAMP_POWER
+#define CURRENT_REFRESH 5 ///< Phase from STAMP_REFRESH
+#define CURRENT_DCDC 6 ///< Phase from STAMP_DCDC to STAMP_END
+#define CURRENT_TOUCH_ACTIVE 7 ///< Touch poll or INT check, I2C transactions included
+#define CURRENT_TOUCH_STANDBY 8 ///< Touch controller suspended
+#define CURRENT_TOUCH_IDLE 9 ///< Touch controller active, between polls
+#define CURRENT_NUMBER 10 ///< Number of currents
+/// @}
+
+///
+/// @name Energy model, totals
+/// @{
+///
+#define ENERGY_UPDATE_NORMAL 0 ///< Normal updates
+#define ENERGY_UPDATE_FAST 1 ///< Fast updates
+#define ENERGY_TOUCH_POLLED 2 ///< Touch polls and time between, polled when idle
+#define ENERGY_TOUCH_INTERRUPT 3 ///< Touch polls and time between, interrupt only when idle
+#define ENERGY_TOUCH_STANDBY 4 ///< Touch controller suspended, added on resume
+#define ENERGY_TOUCH_CHECK 5 ///< GPIO-only INT checks, without I2C
+#define ENERGY_NUMBER 6 ///< Number of totals
+/// @}
+
+///
+/// @brief Temperature provider
+/// @return int8_t temperature in Celsius, TEMPERATURE_INVALID if not available
+///
+typedef int8_t (*temperatureProvider_t)();
+#define TEMPERATURE_INVALID INT8_MIN ///< Provider failed
+
 ///
 /// @brief Driver variant
 ///
@@ -132,6 +229,507 @@ class Pervasive_Touch_Small : public Driver_EPD_Virtual
 
     /// @}
 
+    /// @name Grey-level frames
+    /// @{
+
+    ///
+    /// @brief Set packing of grey-level frames
+    ///
+    /// @param mode PACKING_THRESHOLD, PACKING_ORDERED or PACKING_DIFFUSION
+    /// @param threshold grey level below which a pixel is black, default 0x80
+    /// @note threshold is only used by PACKING_THRESHOLD
+    ///
+    void setPacking(uint8_t mode, uint8_t threshold = 0x80);
+
+    ///
+    /// @brief Normal update with a grey-level frame
+    ///
+    /// @param grey next image, one byte per pixel
+    /// @param sizeGrey size of the grey-level frame
+    /// @note Rows are packed on the fly, no monochrome frame is required
+    ///
+    void updateNormalGrey(FRAMEBUFFER_CONST_TYPE grey, uint32_t sizeGrey);
+
+    ///
+    /// @brief Fast update with grey-level frames
+    ///
+    /// @param grey1 next image, one byte per pixel
+    /// @param grey2 previous image, one byte per pixel
+    /// @param sizeGrey size of each grey-level frame
+    /// @note Rows are packed on the fly, no monochrome frame is required
+    ///
+    void updateFastGrey(FRAMEBUFFER_CONST_TYPE grey1,
+                        FRAMEBUFFER_CONST_TYPE grey2, uint32_t sizeGrey);
+
+    /// @}
+
+    /// @name Orientation
+    /// @{
+
+    ///
+    /// @brief Set orientation of the frames passed to updateNormal() and updateFast()
+    ///
+    /// @param orientation 0 = native, 1 = 90°, 2 = 180°, 3 = 270°, clockwise
+    /// @note Frames are rotated during transmission, no copy is required
+    /// @note With 1 and 3, width and height of the frame are swapped
+    /// @note Grey-level frames are always in native orientation
+    ///
+    void setFrameOrientation(uint8_t orientation);
+
+    ///
+    /// @brief Get orientation of the frames
+    ///
+    /// @return uint8_t 0 = native, 1 = 90°, 2 = 180°, 3 = 270°
+    ///
+    uint8_t getFrameOrientation();
+
+    /// @}
+
+    /// @name Frame assets
+    /// @details Store of pre-packed frames in native orientation, generated by extras/frame_assets.py
+    /// @n The store is read in place, from flash or from a memory-mapped file
+    /// @{
+
+    ///
+    /// @brief Normal update with a frame from a store
+    ///
+    /// @param store frame assets store
+    /// @param sizeStore size of the store
+    /// @param identifier identifier of the frame
+    /// @return uint8_t RESULT_SUCCESS or RESULT_ERROR if the frame is not found or does not fit the screen
+    ///
+    uint8_t updateNormalAsset(FRAMEBUFFER_CONST_TYPE store, uint32_t sizeStore,
+                              uint16_t identifier);
+
+    ///
+    /// @brief Fast update with frames from a store
+    ///
+    /// @param store frame assets store
+    /// @param sizeStore size of the store
+    /// @param identifier1 identifier of the next frame
+    /// @param identifier2 identifier of the previous frame
+    /// @return uint8_t RESULT_SUCCESS or RESULT_ERROR if a frame is not found or does not fit the screen
+    ///
+    uint8_t updateFastAsset(FRAMEBUFFER_CONST_TYPE store, uint32_t sizeStore,
+                            uint16_t identifier1, uint16_t identifier2);
+
+    /// @}
+
+    /// @name Latency
+    /// @details Touch-to-glass latency, from touch interrupt edge to BUSY released after refresh
+    /// @{
+
+    ///
+    /// @brief Get time stamp
+    ///
+    /// @param stamp STAMP_INTERRUPT to STAMP_END
+    /// @return uint32_t time in ms, 0 if not reached during the last update
+    ///
+    uint32_t getStamp(uint8_t stamp);
+
+    ///
+    /// @brief Get touch-to-glass latency percentile
+    ///
+    /// @param percentile 0 to 100, for example 50, 95 or 99
+    /// @return uint32_t upper bound of the latency in ms, within 12.5%
+    ///
+    uint32_t getLatencyPercentile(uint8_t percentile);
+
+    ///
+    /// @brief Get number of latency measures
+    ///
+    /// @return uint32_t number of updates served after a touch
+    ///
+    uint32_t getLatencyCount();
+
+    ///
+    /// @brief Get duration of the CoG initialisation during the last update
+    ///
+    /// @return uint32_t time in us, command list from soft-reset to last initial command
+    ///
+    uint32_t getInitialDuration();
+
+    ///
+    /// @brief Time-stamp the touch interrupt edge
+    /// @note Optional, call from the interrupt service routine on touchInt falling edge
+    /// @n Otherwise, the edge is time-stamped when the interrupt is polled
+    ///
+    void stampInterrupt();
+
+    ///
+    /// @brief Reset latency measures
+    ///
+    void resetLatency();
+
+    /// @}
+
+    /// @name Touch trace
+    /// @{
+
+    ///
+    /// @brief Start recording touch activity
+    ///
+    /// @param buffer buffer for the trace
+    /// @param sizeBuffer size of the buffer
+    /// @param scope combination of TRACE_TOUCH, TRACE_INTERRUPT and TRACE_WIRE, default TRACE_ALL
+    /// @note Recording stops when the buffer is full, the trace recorded so far is kept
+    ///
+    void beginTouchRecord(uint8_t * buffer, uint32_t sizeBuffer, uint8_t scope = TRACE_ALL);
+
+    ///
+    /// @brief Stop recording touch activity
+    ///
+    /// @return uint32_t size of the trace
+    ///
+    uint32_t endTouchRecord();
+
+    ///
+    /// @brief Start replaying a touch trace instead of the touch controller
+    ///
+    /// @param buffer trace
+    /// @param sizeBuffer size of the trace
+    /// @param speed 0 = as fast as polled, 1 = recorded speed, n = n times faster
+    /// @note At speed 0, each poll takes the next recorded poll
+    /// @n At speed 1 or more, each poll takes the INT level and the I2C replies
+    /// @n of the latest recorded poll due, so polling may differ from the record
+    /// @note With TRACE_WIRE records, the recorded bytes go through the touch parser
+    /// @n and the results are checked against TRACE_TOUCH records
+    /// @n Without TRACE_WIRE records, TRACE_TOUCH records are returned as is,
+    /// @n moves superseded by a later due record are skipped
+    ///
+    void beginTouchReplay(FRAMEBUFFER_CONST_TYPE buffer, uint32_t sizeBuffer, uint8_t speed = 0);
+
+    ///
+    /// @brief Stop replaying a touch trace
+    ///
+    /// @return uint32_t number of parser results different from TRACE_TOUCH records,
+    /// @n of missing TRACE_WIRE records for the address and register,
+    /// @n and of recorded presses not replayed
+    ///
+    uint32_t endTouchReplay();
+
+    /// @}
+
+    /// @name SPI clock
+    /// @{
+
+    ///
+    /// @brief Set SPI clock for image transfers
+    ///
+    /// @param speed clock in Hz, default 16 MHz
+    /// @note Store the value from calibrateSpeedSPI() per unit and restore it after begin()
+    ///
+    void setSpeedSPI(uint32_t speed);
+
+    ///
+    /// @brief Get SPI clock for image transfers
+    ///
+    /// @return uint32_t clock in Hz
+    ///
+    uint32_t getSpeedSPI();
+
+    ///
+    /// @brief Calibrate SPI clock for image transfers
+    ///
+    /// @param speedMaximum highest clock to try in Hz, default and limit 16 MHz
+    /// @return uint32_t highest clock passing the checks in Hz, also set for next updates
+    /// @note Clock is stepped up from 4 MHz until a check fails
+    /// @n At each step, initial commands and a full frame are sent at the clock,
+    /// @n then power on and DC/DC off shall each be acknowledged by BUSY
+    /// @note 4-wire SPI has no read-back, so clocks above 16 MHz are not tried
+    /// @note The screen is not refreshed
+    ///
+    uint32_t calibrateSpeedSPI(uint32_t speedMaximum = 16000000);
+
+    ///
+    /// @brief Get SPI throughput measured during last calibration
+    ///
+    /// @return uint32_t throughput in bytes per second, 0 if not calibrated
+    ///
+    uint32_t getThroughputSPI();
+
+    /// @}
+
+    /// @name Fingerprint
+    /// @details Hash of the image on the glass, with screen and frame orientation
+    /// @n The screen is bistable, so the fingerprint stays valid across sleep cycles
+    /// @{
+
+    ///
+    /// @brief Normal update only if the image differs from the image on the glass
+    ///
+    /// @param frame next image
+    /// @param sizeFrame size of the frame
+    /// @return true if updated, false if skipped or frame size wrong
+    ///
+    bool updateNormalIfChanged(FRAMEBUFFER_CONST_TYPE frame, uint32_t sizeFrame);
+
+    ///
+    /// @brief Get fingerprint of the image on the glass
+    ///
+    /// @return uint32_t fingerprint, 0 if unknown
+    /// @note Save to retained RAM, NVM or file before sleep
+    ///
+    uint32_t getFingerprint();
+
+    ///
+    /// @brief Set fingerprint of the image on the glass
+    ///
+    /// @param fingerprint value saved before sleep, 0 if unknown
+    ///
+    void setFingerprint(uint32_t fingerprint);
+
+    /// @}
+
+    /// @name Touch filter
+    /// @details Median, then exponential smoothing, then dead-zone on MOVE events
+    /// @n Fixed-point, no allocation
+    /// @{
+
+    ///
+    /// @brief Set touch filter
+    ///
+    /// @param median number of samples for the median, 1 = off, 3 or 5
+    /// @param smoothing weight of the new sample, 1 to 255 / 256, 0 = off
+    /// @param deadZone MOVE events within deadZone counts on both axes are suppressed, 0 = off
+    /// @note Default is off, statistics are reset
+    ///
+    void setTouchFilter(uint8_t median, uint8_t smoothing, uint8_t deadZone);
+
+    ///
+    /// @brief Get measured jitter
+    ///
+    /// @return uint16_t mean absolute difference between raw and filtered positions, in 1/16 counts
+    ///
+    uint16_t getTouchJitter();
+
+    ///
+    /// @brief Get number of suppressed MOVE events
+    ///
+    /// @return uint32_t suppressed events since setTouchFilter()
+    ///
+    uint32_t getTouchSuppressed();
+
+    /// @}
+
+    /// @name Touch regions
+    /// @details Rectangles indexed by a grid of 32x32 cells over the touch coordinates
+    /// @n Overlapping regions are allowed, the highest identifier wins
+    /// @{
+
+    ///
+    /// @brief Add or replace a touch region
+    ///
+    /// @param identifier 0 to REGION_NUMBER - 1
+    /// @param x0 left, touch coordinates
+    /// @param y0 top, touch coordinates
+    /// @param dx width
+    /// @param dy height
+    /// @return uint8_t RESULT_SUCCESS or RESULT_ERROR
+    ///
+    uint8_t addTouchRegion(uint8_t identifier, uint16_t x0, uint16_t y0, uint16_t dx, uint16_t dy);
+
+    ///
+    /// @brief Remove a touch region
+    ///
+    /// @param identifier 0 to REGION_NUMBER - 1
+    ///
+    void removeTouchRegion(uint8_t identifier);
+
+    ///
+    /// @brief Get the touch region of a touch
+    ///
+    /// @param touch touch from the driver
+    /// @return uint8_t identifier or REGION_NONE
+    ///
+    uint8_t getTouchRegion(touch_t touch);
+
+    /// @}
+
+    /// @name Touch polling
+    /// @details Fast polling during contact, slowing down when idle
+    /// @{
+
+    ///
+    /// @brief Set adaptive touch polling
+    ///
+    /// @param periodActive period in ms during contact, latency budget
+    /// @param periodIdle longest period in ms when idle, power budget
+    /// @param flagInterruptIdle true = when idle, poll only on interrupt
+    /// @note When idle, the period doubles at each poll from periodActive to periodIdle
+    /// @note flagInterruptIdle is ignored on 2.71", polling continues at periodIdle
+    /// @note Statistics are reset
+    ///
+    void setTouchPolling(uint16_t periodActive, uint16_t periodIdle, bool flagInterruptIdle = false);
+
+    ///
+    /// @brief Poll touch when due
+    ///
+    /// @param touch touch, only when polled
+    /// @return true if polled, false if not due
+    /// @note Call as often as possible, for example from loop()
+    ///
+    bool pollTouch(touch_t & touch);
+
+    ///
+    /// @brief Get effective touch sample rate
+    ///
+    /// @return uint32_t polls per minute since setTouchPolling()
+    ///
+    uint32_t getTouchPollsPerMinute();
+
+    ///
+    /// @brief Get touch I2C traffic
+    ///
+    /// @return uint32_t I2C transactions per minute since setTouchPolling()
+    ///
+    uint32_t getTouchTransactionsPerMinute();
+
+    /// @}
+
+    /// @name Touch controller power
+    /// @{
+
+    ///
+    /// @brief Suspend touch controller
+    ///
+    /// @param mode TOUCH_POWER_MONITOR or TOUCH_POWER_SLEEP, default TOUCH_POWER_MONITOR
+    /// @note I2C bus and GPIOs are kept, INT remains armed
+    /// @note With TOUCH_POWER_MONITOR, a touch resumes the controller on next poll
+    /// @note TOUCH_POWER_MONITOR is refused on 2.71", the controller stays active
+    /// @note A contact in progress is released on next poll
+    ///
+    void suspendTouch(uint8_t mode = TOUCH_POWER_MONITOR);
+
+    ///
+    /// @brief Resume touch controller
+    /// @note From TOUCH_POWER_MONITOR, no reset
+    /// @n From TOUCH_POWER_SLEEP, /RESET sequence
+    ///
+    void resumeTouch();
+
+    ///
+    /// @brief Get touch controller power mode
+    ///
+    /// @return uint8_t TOUCH_POWER_ACTIVE, TOUCH_POWER_MONITOR or TOUCH_POWER_SLEEP
+    ///
+    uint8_t getTouchPower();
+
+    ///
+    /// @brief Get total time in suspend
+    ///
+    /// @return uint32_t time in ms
+    ///
+    uint32_t getTouchStandbyTime();
+
+    ///
+    /// @brief Get duration of last resume
+    ///
+    /// @return uint32_t time in ms
+    ///
+    uint32_t getTouchResumeTime();
+
+    /// @}
+
+    /// @name Power policy
+    /// @details Keep SPI and GPIOs of the screen resident between frequent updates
+    /// @{
+
+    ///
+    /// @brief Set power policy between updates
+    ///
+    /// @param periodKeep average period between updates in ms under which peripherals are kept
+    /// @param periodRelease average period between updates in ms over which peripherals are suspended
+    /// @note periodRelease >= periodKeep, the difference is the hysteresis
+    /// @note Default 0, 0 = policy off, peripherals are resumed for each update as before
+    /// @note The touch controller is not changed, use suspendTouch() and resumeTouch()
+    ///
+    void setPowerPolicy(uint32_t periodKeep, uint32_t periodRelease);
+
+    ///
+    /// @brief Get number of updates started with peripherals already on
+    ///
+    /// @return uint32_t number of resumes avoided
+    ///
+    uint32_t getPowerAvoided();
+
+    ///
+    /// @brief Get number of suspends decided by the power policy
+    ///
+    /// @return uint32_t number of suspends
+    ///
+    uint32_t getPowerSuspended();
+
+    /// @}
+
+    /// @name Energy model
+    /// @details Estimated charge from measured phase durations and calibrated currents
+    /// @{
+
+    ///
+    /// @brief Set calibration table
+    ///
+    /// @param currents table of CURRENT_NUMBER currents in uA
+    /// @note Default is 0 for all items, so no estimate
+    ///
+    void setEnergyCurrents(const uint16_t * currents);
+
+    ///
+    /// @brief Get estimated charge
+    ///
+    /// @param item ENERGY_UPDATE_NORMAL to ENERGY_TOUCH_CHECK
+    /// @return uint32_t charge in uC
+    /// @note Touch polls are charged to the polling mode set by setTouchPolling()
+    ///
+    uint32_t getEnergy(uint8_t item);
+
+    ///
+    /// @brief Get number of events
+    ///
+    /// @param item ENERGY_UPDATE_NORMAL to ENERGY_TOUCH_CHECK
+    /// @return uint32_t number of updates, polls, suspends or checks
+    ///
+    uint32_t getEnergyCount(uint8_t item);
+
+    ///
+    /// @brief Reset estimated charges and numbers of events
+    ///
+    void resetEnergy();
+
+    /// @}
+
+    /// @name Temperature cache
+    /// @details Temperature for COG_initial() from a provider, queried only when required
+    /// @{
+
+    ///
+    /// @brief Set temperature provider
+    ///
+    /// @param provider function returning the temperature in Celsius, nullptr = none
+    /// @param periodRefresh age in ms after which the provider is queried again
+    /// @param hysteresis change in Celsius required to update the cached value, 0 = none
+    /// @param periodStale age in ms after which a failing provider falls back to 25 Celsius
+    /// @note Without provider, temperature is set by the application as before
+    ///
+    void setTemperatureProvider(temperatureProvider_t provider, uint32_t periodRefresh = 60000,
+                                uint8_t hysteresis = 1, uint32_t periodStale = 600000);
+
+    ///
+    /// @brief Get number of updates served by the cached temperature
+    ///
+    /// @return uint32_t cache hits
+    ///
+    uint32_t getTemperatureHits();
+
+    ///
+    /// @brief Get number of provider queries
+    ///
+    /// @return uint32_t cache misses
+    ///
+    uint32_t getTemperatureMisses();
+
+    /// @}
+
   protected:
 
     //
@@ -148,6 +746,10 @@ class Pervasive_Touch_Small : public Driver_EPD_Virtual
     // Variables and functions specific to the screen
     uint8_t COG_data[112]; // OTP
     bool s_flag50; // Register 0x50
+    uint16_t s_sizeX, s_sizeY; // Native scan order, pixels
+
+    void d_beginUpdate(uint8_t updateMode);
+    void d_endUpdate();
 
     void COG_reset();
     void COG_getDataOTP();
@@ -156,6 +758,212 @@ class Pervasive_Touch_Small : public Driver_EPD_Virtual
     void COG_sendImageDataNormal(FRAMEBUFFER_CONST_TYPE frame1, uint32_t sizeFrame);
     void COG_update();
     void COG_stopDCDC();
+    void COG_sendList(const uint8_t * list);
+
+    //
+    // === Packing section
+    //
+    uint8_t s_packingMode = PACKING_THRESHOLD;
+    uint8_t s_packingThreshold = 0x80;
+
+    void COG_selectIndex(uint8_t index);
+    void COG_unselect();
+    void COG_packRow(FRAMEBUFFER_CONST_TYPE greyRow, uint16_t row, uint8_t * packedRow, int16_t * errorRow);
+    void COG_sendIndexGrey(uint8_t index, FRAMEBUFFER_CONST_TYPE grey);
+    void COG_sendRowsGrey(uint8_t index, FRAMEBUFFER_CONST_TYPE grey, int16_t * errorRow);
+    //
+    // === End of Packing section
+    //
+
+    //
+    // === Orientation section
+    //
+    uint8_t s_frameOrientation = 0;
+
+    void COG_sendIndexFrame(uint8_t index, FRAMEBUFFER_CONST_TYPE frame, uint32_t sizeFrame);
+    //
+    // === End of Orientation section
+    //
+
+    //
+    // === Frame assets section
+    //
+    uint8_t d_findFrameAsset(FRAMEBUFFER_CONST_TYPE store, uint32_t sizeStore, uint16_t identifier,
+                             FRAMEBUFFER_CONST_TYPE & frame, uint32_t & sizeFrame);
+    //
+    // === End of Frame assets section
+    //
+
+    //
+    // === Latency section
+    //
+    uint32_t d_stamps[STAMP_NUMBER] = {0};
+    volatile uint32_t d_stampInterrupt = 0; // Pending touch, 0 = none, set by stampInterrupt() from ISR
+    uint32_t d_stampTouch = 0; // Pending press, 0 = none
+    volatile uint32_t d_stampRelease = 0; // Last release, read by stampInterrupt() from ISR
+    uint16_t d_latencyBuckets[128] = {0}; // 8 buckets per power of 2
+    uint32_t d_latencyCount = 0;
+    uint32_t d_initialDuration = 0; // us
+
+    void d_stamp(uint8_t stamp);
+    void d_stampTouchEvent(bool flagInterrupt, uint8_t event);
+    //
+    // === End of Latency section
+    //
+
+    //
+    // === Trace section
+    //
+    uint8_t d_traceMode = 0; // 0 = off, TRACE_RECORD, TRACE_REPLAY
+    uint8_t d_traceScope = 0;
+    uint8_t * d_traceRecord = nullptr;
+    FRAMEBUFFER_CONST_TYPE d_traceReplay = nullptr;
+    uint32_t d_traceSize = 0;
+    uint32_t d_traceLength = 0; // Record, used size
+    bool d_traceFull = false; // Record, buffer full
+    uint8_t d_traceLevel = HIGH; // Record, last INT level recorded
+    uint32_t d_traceCursor[3] = {0}; // Replay, latest due record, one per record type, 0 = none
+    uint32_t d_traceGroup[3] = {0}; // Replay, first record with the same time as the cursor
+    uint32_t d_traceNext[3] = {0}; // Replay, next record after the cursor
+    uint32_t d_tracePosition = 0; // Replay at speed 0, first record after d_traceNow
+    uint32_t d_traceNow = 0; // Replay at speed 0, time of the last poll
+    uint32_t d_traceChrono = 0; // Time of the current poll, shared by its records
+    uint32_t d_traceStart = 0;
+    uint8_t d_traceSpeed = 0;
+    uint32_t d_traceMismatches = 0;
+    uint32_t d_tracePresses = 0; // Replay, presses recorded
+    uint32_t d_tracePressesReplayed = 0; // Replay, presses returned
+
+    uint8_t d_readInterrupt();
+    void d_readTouch(uint8_t command, uint8_t * bufferRead, uint8_t sizeRead);
+    void d_traceTick(bool flagAdvance);
+    void d_traceWrite(uint8_t type, const uint8_t * payload, uint8_t length);
+    bool d_traceRead(uint8_t type, uint8_t * payload, uint8_t length, uint8_t command = 0);
+    bool d_traceReadEvent(uint8_t * payload);
+    uint32_t d_traceFind(uint8_t type, uint32_t position);
+    uint32_t d_traceStamp(uint32_t position);
+    //
+    // === End of Trace section
+    //
+
+    //
+    // === SPI clock section
+    //
+    uint32_t s_speedSPI = 16000000;
+    uint32_t s_throughputSPI = 0;
+
+    bool COG_checkSpeedSPI(uint32_t speed, uint32_t & throughput);
+    bool COG_checkBusy(uint32_t timeout);
+    //
+    // === End of SPI clock section
+    //
+
+    //
+    // === Fingerprint section
+    //
+    uint32_t s_fingerprint = 0; // 0 = unknown
+
+    uint32_t d_getFingerprint(FRAMEBUFFER_CONST_TYPE frame, uint32_t sizeFrame);
+    //
+    // === End of Fingerprint section
+    //
+
+    //
+    // === Touch filter section
+    //
+    uint8_t d_filterMedian = 1;
+    uint8_t d_filterSmoothing = 0;
+    uint8_t d_filterDeadZone = 0;
+    uint16_t d_filterX[5], d_filterY[5]; // Last samples, circular
+    uint8_t d_filterCount = 0;
+    uint8_t d_filterIndex = 0;
+    uint32_t d_filterSmoothX, d_filterSmoothY; // 1/16 counts
+    uint16_t d_filterLastX, d_filterLastY; // Last reported
+    uint32_t d_filterJitterSum = 0; // 1/16 counts
+    uint32_t d_filterJitterCount = 0;
+    uint32_t d_filterSuppressed = 0;
+
+    void d_filterTouch(touch_t & touch);
+    //
+    // === End of Touch filter section
+    //
+
+    //
+    // === Touch regions section
+    //
+    uint16_t d_regionX0[REGION_NUMBER], d_regionY0[REGION_NUMBER];
+    uint16_t d_regionX1[REGION_NUMBER], d_regionY1[REGION_NUMBER]; // Exclusive
+    uint32_t d_regionCells[8 * 13] = {0}; // Bit per region, 32x32 cells, largest screen 240x416
+
+    void d_markTouchRegion(uint8_t identifier, bool flagSet);
+    //
+    // === End of Touch regions section
+    //
+
+    //
+    // === Touch polling section
+    //
+    uint16_t d_pollActive = 20;
+    uint16_t d_pollIdle = 320;
+    bool d_pollInterruptIdle = false;
+    uint16_t d_pollPeriod = 20;
+    uint32_t d_pollLast = 0;
+    uint32_t d_pollStart = 0;
+    uint32_t d_pollCount = 0;
+    uint32_t d_touchTransactions = 0; // I2C transactions, all callers
+    uint32_t d_pollTransactions = 0; // At start
+    //
+    // === End of Touch polling section
+    //
+
+    //
+    // === Power policy section
+    //
+    uint32_t s_policyKeep = 0;
+    uint32_t s_policyRelease = 0;
+    bool s_flagResident = false;
+    uint32_t s_updateLast = 0;
+    uint32_t s_updatePeriod = 0; // Average, ms
+    uint32_t s_policyAvoided = 0;
+    uint32_t s_policySuspended = 0;
+
+    void d_applyPowerPolicy();
+    //
+    // === End of Power policy section
+    //
+
+    //
+    // === Energy section
+    //
+    uint8_t s_updateMode = UPDATE_NORMAL;
+    uint16_t d_energyCurrents[CURRENT_NUMBER] = {0}; // uA
+    uint64_t d_energyCharges[ENERGY_NUMBER] = {0}; // nC = uA * ms
+    uint32_t d_energyCounts[ENERGY_NUMBER] = {0};
+    uint32_t d_energyIdleStart = 0; // Touch active, end of last poll, 0 = none
+
+    void d_addEnergy(uint8_t item, uint8_t current, uint32_t duration);
+    void d_addEnergyIdle(uint32_t chrono);
+    //
+    // === End of Energy section
+    //
+
+    //
+    // === Temperature section
+    //
+    temperatureProvider_t s_temperatureProvider = nullptr;
+    uint32_t s_temperatureRefresh = 60000;
+    uint32_t s_temperatureStale = 600000;
+    uint8_t s_temperatureHysteresis = 1;
+    int8_t s_temperatureCached = 25;
+    uint32_t s_temperatureLast = 0; // Last valid query, 0 = none
+    uint32_t s_temperatureQuery = 0; // Last query
+    uint32_t s_temperatureHits = 0;
+    uint32_t s_temperatureMisses = 0;
+
+    void d_refreshTemperature();
+    //
+    // === End of Temperature section
+    //
 
     //
     // === Touch section
@@ -164,8 +972,13 @@ class Pervasive_Touch_Small : public Driver_EPD_Virtual
     uint8_t d_touchPrevious;
     uint16_t d_touchX, d_touchY;
     uint8_t d_fsmPowerTouch = FSM_OFF;
+    uint8_t d_touchPower = TOUCH_POWER_ACTIVE;
+    uint32_t d_touchSuspendStart = 0;
+    uint32_t d_touchStandby = 0;
+    uint32_t d_touchResume = 0;
 
     void d_beginTouch();
+    void d_resetTouch();
     //
     // === End of Touch section
     //